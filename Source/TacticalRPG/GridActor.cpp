@@ -4,17 +4,30 @@
 #include "GridActor.h"
 
 #include "Editor.h"
+#include "GridBakedGrid.h"
 #include "GridData.h"
 #include "GridModifierVolume.h"
+#include "GridPathfinding.h"
+#include "GridStats.h"
 #include "MathUtil.h"
 #include "TacticalBattleCameraPawn.h"
 #include "TacticalBattleCharacter.h"
+#include "Async/Async.h"
 #include "Components/CapsuleComponent.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Components/InstancedStaticMeshComponent.h"
 #include "Editor/EditorEngine.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "Misc/PackageName.h"
 
+namespace
+{
+	constexpr float GroundTraceRadius = 50.f;
+	constexpr float GroundTraceDepth = 1000.f;
+	//Progress is broadcast every time this many more columns have been traced
+	constexpr int32 GenerationProgressStep = 1024;
+}
 
 // Sets default values
 AGridActor::AGridActor()
@@ -32,15 +45,35 @@ AGridActor::AGridActor()
 
 void AGridActor::PlaceCharacterInGrid(const FIntVector2& TargetTile, ATacticalBattleCharacter* Character)
 {
-	if(!ContainsTileWithIndex(TargetTile))
+	if(!ContainsTileWithIndex(TargetTile) || Character == nullptr)
 	{
 		UE_LOG(LogTemp,Warning, TEXT("Tried to place character at invalid grid tile."))
+		return;
+	}
+	int32 UnitHandle = OccupantCharacters.Find(Character);
+	if(UnitHandle == INDEX_NONE)
+	{
+		UnitHandle = Simulation.AddUnit(Character->MakeBattleUnit(TargetTile));
+		if(UnitHandle == INDEX_NONE)
+		{
+			UE_LOG(LogTemp,Warning, TEXT("Tried to place character on an occupied grid tile."))
+			return;
+		}
+		if(OccupantCharacters.Num() <= UnitHandle)
+		{
+			OccupantCharacters.SetNum(UnitHandle + 1);
+		}
+		OccupantCharacters[UnitHandle] = Character;
 	}
-	auto* TileData = TileDataMap.FindChecked(TargetTile);
-	TileData->SetOccupantCharacter(Character);
+	else if(!Simulation.PlaceUnit(UnitHandle, TargetTile))
+	{
+		UE_LOG(LogTemp,Warning, TEXT("Tried to place character on an occupied grid tile."))
+		return;
+	}
+	const int32 TileId = TileStore.ToTileId(TargetTile);
 	Character->CurrentPosition = TargetTile;
 	FTransform TileTransform;
-	InstancedStaticMeshComponent->GetInstanceTransform(TileData->GetInstanceIndex(), TileTransform, true);
+	GetTileChunkComponent(TileId)->GetInstanceTransform(TileStore.GetInstanceIndex(TileId), TileTransform, true);
 	const FVector TileLocation = TileTransform.GetLocation();
 	Character->SetActorLocation(FVector(TileLocation.X, TileLocation.Y, TileLocation.Z + Character->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight()),false,nullptr, ETeleportType::TeleportPhysics);
 }
@@ -50,7 +83,10 @@ void AGridActor::BeginPlay()
 {
 	Super::BeginPlay();
 
-	RegenerateEnvironmentGrid();
+	if(!bUseBakedGrid || !LoadBakedGrid())
+	{
+		RegenerateEnvironmentGrid();
+	}
 
 	auto* CameraControl = Cast<ATacticalBattleCameraPawn>(UGameplayStatics::GetPlayerController(GetWorld(), 0)->GetPawn());
 	if(CameraControl!= nullptr)
@@ -72,11 +108,13 @@ void AGridActor::RegenerateDefaultGrid()
 
 void AGridActor::SpawnGridAt(FVector SpawnLocation, bool bUseEnvironment, bool bDestroyIfExists)
 {
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridSpawn);
 	if(GridData.IsNull())
 	{
 		UE_LOG(LogTemp,Warning, TEXT("No GridData set before spawning!"));
 		return;
 	}
+	CancelGridGeneration();
 	const auto* SetGridData = GridData.LoadSynchronous();
 	SetActorLocation(SpawnLocation);
 	if(bDestroyIfExists)
@@ -86,37 +124,384 @@ void AGridActor::SpawnGridAt(FVector SpawnLocation, bool bUseEnvironment, bool b
 	InstancedStaticMeshComponent->SetStaticMesh(SetGridData->GetTileMesh().LoadSynchronous());
 	
 	const FIntVector2 GridDimension = SetGridData->GetGridDimension();
-	const float GridStep = InstancedStaticMeshComponent->GetStaticMesh()->GetBoundingBox().GetSize().X;
-	for(int i = 0; i<GridDimension.X; i++)
+	Simulation.Reset();
+	OccupantCharacters.Empty();
+	TileStore.Init(GridDimension);
+	TileHighlights.Init(TileStore.GetNumCells());
+	GridStep = InstancedStaticMeshComponent->GetStaticMesh()->GetBoundingBox().GetSize().X;
+	bIsEnvironmentGrid = bUseEnvironment;
+	if(bUseEnvironment)
 	{
-		for(int j = 0; j<GridDimension.Y; j++)
+		StartEnvironmentGeneration(GridDimension, GridStep);
+		return;
+	}
+
+	const FGridModifierVolumeData DefaultTileSettings{};
+	TArray<int32> TileIds{};
+	TArray<FTransform> TileTransforms{};
+	TArray<int32> MovementCosts{};
+	TArray<uint8> AllowedMovement{};
+	for(int32 ChunkId = 0; ChunkId < TileStore.GetNumChunks(); ChunkId++)
+	{
+		TileIds.Reset();
+		TileTransforms.Reset();
+		TileStore.ForEachCellInChunk(ChunkId, [&](const int32 TileId)
 		{
-			FVector TileLocation {GridStep * i, GridStep*j, 0};
-			FTransform TileTransform;
+			const FIntVector2 TileIndex = TileStore.ToGridIndex(TileId);
+			TileIds.Emplace(TileId);
+			TileTransforms.Emplace(FVector{GridStep * TileIndex.X, GridStep * TileIndex.Y, 0});
+		});
+		MovementCosts.Init(DefaultTileSettings.ModifiedMovementCost, TileIds.Num());
+		AllowedMovement.Init(DefaultTileSettings.VolumeAllowedMovement, TileIds.Num());
+		AddTilesToChunk(ChunkId, TileIds, TileTransforms, MovementCosts, AllowedMovement);
+	}
+	OnGridGenerated.Broadcast();
+}
+
+void AGridActor::RegenerateRegion(const FBox& WorldBounds)
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridRegenerateRegion);
+	if(!bIsEnvironmentGrid || IsGeneratingGrid() || GridStep <= 0.f || !WorldBounds.IsValid)
+	{
+		return;
+	}
+	//Columns are swept from the lattice below GetActorLocation, a sphere reaches GroundTraceRadius past its column
+	const FVector Origin = GetActorLocation();
+	const FIntVector2 MinIndex {
+		FMath::Max(FMath::CeilToInt((WorldBounds.Min.X - Origin.X - GroundTraceRadius) / GridStep), 0),
+		FMath::Max(FMath::CeilToInt((WorldBounds.Min.Y - Origin.Y - GroundTraceRadius) / GridStep), 0)};
+	const FIntVector2 MaxIndex {
+		FMath::Min(FMath::FloorToInt((WorldBounds.Max.X - Origin.X + GroundTraceRadius) / GridStep), TileStore.GetDimension().X - 1),
+		FMath::Min(FMath::FloorToInt((WorldBounds.Max.Y - Origin.Y + GroundTraceRadius) / GridStep), TileStore.GetDimension().Y - 1)};
+	if(MinIndex.X > MaxIndex.X || MinIndex.Y > MaxIndex.Y)
+	{
+		return;
+	}
+
+	TBitArray<> MovedChunks{false, TileStore.GetNumChunks()};
+	int32 NumPatched = 0;
+	for(int32 Y = MinIndex.Y; Y <= MaxIndex.Y; Y++)
+	{
+		for(int32 X = MinIndex.X; X <= MaxIndex.X; X++)
+		{
+			const FIntVector2 TileIndex{X, Y};
+			const int32 TileId = TileStore.ToTileId(TileIndex);
+			FVector HitLocation;
 			FGridModifierVolumeData VolumeData;
-			if(bUseEnvironment)
+			if(!TraceForGround(Origin + FVector{GridStep * X, GridStep * Y, 0}, HitLocation, VolumeData))
 			{
-				FVector NewLocation{};
-				const bool bSpawnTile = TraceForGround(GetActorLocation() + TileLocation,NewLocation, VolumeData);
-				if(bSpawnTile)
-				{
-					TileTransform = FTransform{NewLocation-GetActorLocation()+FVector{0,0,1}};
-					AddTileAt(TileTransform, {i,j}, VolumeData);
-				}
-				
+				NumPatched += RemoveTileAt(TileIndex) ? 1 : 0;
 				continue;
 			}
-			TileTransform = FTransform{TileLocation};
-			AddTileAt(TileTransform, {i,j}, VolumeData);
+			const FTransform TileTransform{HitLocation - Origin + FVector{0,0,1}};
+			if(!TileStore.HasTile(TileId))
+			{
+				AddTileAt(TileTransform, TileIndex, VolumeData);
+				++NumPatched;
+				continue;
+			}
+			const int32 MovementCost = FGridTileStore::ClampMovementCost(VolumeData.ModifiedMovementCost);
+			if(TileStore.GetMovementCost(TileId) != MovementCost)
+			{
+				TileStore.SetMovementCost(TileId, MovementCost);
+			}
+			if(TileStore.GetAllowedMovementTypes(TileId) != VolumeData.VolumeAllowedMovement)
+			{
+				TileStore.SetAllowedMovementTypes(TileId, VolumeData.VolumeAllowedMovement);
+			}
+			if(!FMath::IsNearlyEqual(TileStore.GetElevation(TileId), static_cast<float>(TileTransform.GetLocation().Z)))
+			{
+				//Render state is refreshed once per chunk below instead of once per instance
+				GetTileChunkComponent(TileId)->UpdateInstanceTransform(TileStore.GetInstanceIndex(TileId), TileTransform, false, false, true);
+				INC_DWORD_STAT(STAT_GridInstanceWrites);
+				TileStore.SetElevation(TileId, TileTransform.GetLocation().Z);
+				MovedChunks[TileStore.GetChunkId(TileId)] = true;
+				++NumPatched;
+			}
+		}
+	}
+	for(TConstSetBitIterator<> It(MovedChunks); It; ++It)
+	{
+		ChunkComponents[It.GetIndex()]->MarkRenderStateDirty();
+	}
+	UE_LOG(LogTemp, Log, TEXT("Regenerated %d columns, %d tiles added, removed or moved."), (MaxIndex.X - MinIndex.X + 1) * (MaxIndex.Y - MinIndex.Y + 1), NumPatched);
+#if WITH_EDITOR
+	if(GetWorld()->WorldType == EWorldType::Editor)
+	{
+		BakeGrid();
+	}
+#endif
+}
+
+FString AGridActor::GetBakedGridFilename() const
+{
+	return FPackageName::LongPackageNameToFilename(GridData.GetLongPackageName(), TEXT(".tgrid"));
+}
+
+void AGridActor::BakeGrid()
+{
+	if(GridData.IsNull() || IsGeneratingGrid())
+	{
+		UE_LOG(LogTemp,Warning, TEXT("Grid can only be baked once it finished generating from a GridData."));
+		return;
+	}
+	FGridBakedGrid BakedGrid;
+	BakedGrid.Capture(TileStore, GridStep, [this](const int32 TileId)
+	{
+		FTransform TileTransform;
+		GetTileChunkComponent(TileId)->GetInstanceTransform(TileStore.GetInstanceIndex(TileId), TileTransform, false);
+		return TileTransform.GetLocation();
+	});
+	const FString Filename = GetBakedGridFilename();
+	if(!BakedGrid.SaveToFile(Filename))
+	{
+		UE_LOG(LogTemp,Warning, TEXT("Failed to write baked grid %s."), *Filename);
+		return;
+	}
+	UE_LOG(LogTemp, Log, TEXT("Baked %d tiles to %s."), BakedGrid.GetNumTiles(), *Filename);
+}
+
+bool AGridActor::LoadBakedGrid()
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridLoadBakedGrid);
+	if(GridData.IsNull())
+	{
+		return false;
+	}
+	FGridBakedGrid BakedGrid;
+	if(!BakedGrid.LoadFromFile(GetBakedGridFilename()))
+	{
+		return false;
+	}
+	const auto* SetGridData = GridData.LoadSynchronous();
+	if(BakedGrid.Dimension != SetGridData->GetGridDimension())
+	{
+		UE_LOG(LogTemp,Warning, TEXT("Baked grid %s does not match the GridData dimension, it needs to be baked again."), *GetBakedGridFilename());
+		return false;
+	}
+	DestroyGrid();
+	InstancedStaticMeshComponent->SetStaticMesh(SetGridData->GetTileMesh().LoadSynchronous());
+	TileStore.Init(BakedGrid.Dimension);
+	TileHighlights.Init(TileStore.GetNumCells());
+	GridStep = BakedGrid.GridStep;
+	bIsEnvironmentGrid = true;
+
+	TArray<int32> TileIds{};
+	TArray<FTransform> TileTransforms{};
+	TArray<int32> MovementCosts{};
+	TArray<uint8> AllowedMovement{};
+	TArray<int32> Heights{};
+	for(int32 ChunkId = 0; ChunkId < TileStore.GetNumChunks(); ChunkId++)
+	{
+		const int32 First = BakedGrid.ChunkTileOffsets[ChunkId];
+		const int32 Num = BakedGrid.ChunkTileOffsets[ChunkId + 1] - First;
+		TileIds.Reset();
+		TileIds.Append(BakedGrid.TileIds.GetData() + First, Num);
+		MovementCosts.Reset();
+		MovementCosts.Append(BakedGrid.MovementCosts.GetData() + First, Num);
+		AllowedMovement.Reset();
+		AllowedMovement.Append(BakedGrid.AllowedMovement.GetData() + First, Num);
+		Heights.Reset();
+		Heights.Append(BakedGrid.Heights.GetData() + First, Num);
+		TileTransforms.Reset(Num);
+		for(int32 i = First; i < First + Num; i++)
+		{
+			TileTransforms.Emplace(FVector(BakedGrid.Locations[i]));
+		}
+		AddTilesToChunk(ChunkId, TileIds, TileTransforms, MovementCosts, AllowedMovement, Heights);
+	}
+	UE_LOG(LogTemp, Log, TEXT("Loaded baked grid with %d tiles out of %d cells."), TileStore.GetNumTiles(), TileStore.GetNumCells());
+	OnGridGenerated.Broadcast();
+	return true;
+}
+
+void AGridActor::StartEnvironmentGeneration(const FIntVector2& GridDimension, const float InGridStep)
+{
+	UWorld* World = GetWorld();
+	if(World == nullptr)
+	{
+		return;
+	}
+	const int32 NumCells = GridDimension.X * GridDimension.Y;
+	PendingGeneration.Origin = GetActorLocation();
+	PendingGeneration.NumCells = NumCells;
+	PendingGeneration.NumPendingTraces = NumCells;
+	PendingGeneration.TileLocations.SetNumUninitialized(NumCells);
+	PendingGeneration.TileMovementCosts.SetNumUninitialized(NumCells);
+	PendingGeneration.TileAllowedMovement.SetNumUninitialized(NumCells);
+	PendingGeneration.SpawnTile.Init(false, NumCells);
+	PendingGeneration.NumPendingTracesPerChunk.Init(0, TileStore.GetNumChunks());
+	for(int32 TileId = 0; TileId < NumCells; TileId++)
+	{
+		++PendingGeneration.NumPendingTracesPerChunk[TileStore.GetChunkId(TileId)];
+	}
+	if(NumCells == 0)
+	{
+		OnGridGenerated.Broadcast();
+		return;
+	}
+
+	//All columns are queued at once, the physics scene resolves them in parallel during the next world tick and the
+	//results land in the flat buffers above through OnGroundTraceCompleted
+	FCollisionQueryParams QueryParams{SCENE_QUERY_STAT(GridGroundTrace), false, this};
+	const FCollisionShape TraceShape = FCollisionShape::MakeSphere(GroundTraceRadius);
+	const FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &AGridActor::OnGroundTraceCompleted, PendingGeneration.RequestId);
+	for(int32 TileId = 0; TileId < NumCells; TileId++)
+	{
+		const FIntVector2 TileIndex = TileStore.ToGridIndex(TileId);
+		const FVector TraceStart = PendingGeneration.Origin + FVector{InGridStep * TileIndex.X, InGridStep * TileIndex.Y, 0};
+		World->AsyncSweepByChannel(EAsyncTraceType::Multi, TraceStart, TraceStart - FVector{0,0,GroundTraceDepth}, FQuat::Identity, ECC_GameTraceChannel1, TraceShape, QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, TileId);
+	}
+	INC_DWORD_STAT_BY(STAT_GridTracesIssued, NumCells);
+}
+
+void AGridActor::OnGroundTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum, const uint32 RequestId)
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridGroundTraceResults);
+	if(RequestId != PendingGeneration.RequestId || !PendingGeneration.IsActive())
+	{
+		return; //Result of a cancelled generation
+	}
+	const int32 TileId = static_cast<int32>(TraceDatum.UserData);
+	FGridModifierVolumeData VolumeData;
+	FVector HitLocation;
+	if(ResolveGroundHits(TraceDatum.OutHits, HitLocation, VolumeData))
+	{
+		PendingGeneration.SpawnTile[TileId] = true;
+		PendingGeneration.TileLocations[TileId] = HitLocation - PendingGeneration.Origin + FVector{0,0,1};
+		PendingGeneration.TileMovementCosts[TileId] = VolumeData.ModifiedMovementCost;
+		PendingGeneration.TileAllowedMovement[TileId] = VolumeData.VolumeAllowedMovement;
+	}
+
+	--PendingGeneration.NumPendingTraces;
+	const int32 ChunkId = TileStore.GetChunkId(TileId);
+	if(--PendingGeneration.NumPendingTracesPerChunk[ChunkId] == 0)
+	{
+		FlushGeneratedChunk(ChunkId);
+	}
+	const int32 NumTraced = PendingGeneration.NumCells - PendingGeneration.NumPendingTraces;
+	if(NumTraced % GenerationProgressStep == 0 || !PendingGeneration.IsActive())
+	{
+		OnGridGenerationProgress.Broadcast(static_cast<float>(NumTraced) / PendingGeneration.NumCells);
+	}
+	if(!PendingGeneration.IsActive())
+	{
+		UE_LOG(LogTemp, Log, TEXT("Generated environment grid with %d tiles out of %d cells."), TileStore.GetNumTiles(), PendingGeneration.NumCells);
+		PendingGeneration = FGridGenerationRequest{PendingGeneration.RequestId};
+#if WITH_EDITOR
+		if(GetWorld()->WorldType == EWorldType::Editor)
+		{
+			BakeGrid();
 		}
+#endif
+		OnGridGenerated.Broadcast();
+	}
+}
+
+void AGridActor::FlushGeneratedChunk(const int32 ChunkId)
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridFlushGeneratedChunk);
+	TArray<int32> TileIds{};
+	TArray<FTransform> TileTransforms{};
+	TArray<int32> MovementCosts{};
+	TArray<uint8> AllowedMovement{};
+	TileStore.ForEachCellInChunk(ChunkId, [&](const int32 TileId)
+	{
+		if(PendingGeneration.SpawnTile[TileId])
+		{
+			TileIds.Emplace(TileId);
+			TileTransforms.Emplace(PendingGeneration.TileLocations[TileId]);
+			MovementCosts.Emplace(PendingGeneration.TileMovementCosts[TileId]);
+			AllowedMovement.Emplace(PendingGeneration.TileAllowedMovement[TileId]);
+		}
+	});
+	AddTilesToChunk(ChunkId, TileIds, TileTransforms, MovementCosts, AllowedMovement);
+}
+
+UHierarchicalInstancedStaticMeshComponent* AGridActor::GetOrCreateChunkComponent(const int32 ChunkId)
+{
+	if(ChunkComponents.Num() != TileStore.GetNumChunks())
+	{
+		ChunkComponents.SetNumZeroed(TileStore.GetNumChunks());
+	}
+	if(ChunkComponents[ChunkId] != nullptr)
+	{
+		return ChunkComponents[ChunkId];
+	}
+	auto* ChunkComponent = NewObject<UHierarchicalInstancedStaticMeshComponent>(this, *FString::Printf(TEXT("GridChunk_%d"), ChunkId), RF_Transient);
+	ChunkComponent->SetStaticMesh(InstancedStaticMeshComponent->GetStaticMesh());
+	for(int32 MaterialIndex = 0; MaterialIndex < InstancedStaticMeshComponent->GetNumMaterials(); MaterialIndex++)
+	{
+		ChunkComponent->SetMaterial(MaterialIndex, InstancedStaticMeshComponent->GetMaterial(MaterialIndex));
+	}
+	ChunkComponent->NumCustomDataFloats = InstancedStaticMeshComponent->NumCustomDataFloats;
+	ChunkComponent->SetCollisionProfileName(InstancedStaticMeshComponent->GetCollisionProfileName());
+	ChunkComponent->SetCollisionResponseToChannels(InstancedStaticMeshComponent->GetCollisionResponseToChannels());
+	if(ChunkCullDistance > 0)
+	{
+		ChunkComponent->SetCullDistances(0, ChunkCullDistance);
 	}
+	ChunkComponent->SetupAttachment(InstancedStaticMeshComponent);
+	ChunkComponent->RegisterComponent();
+	ChunkComponents[ChunkId] = ChunkComponent;
+	return ChunkComponent;
+}
+
+UHierarchicalInstancedStaticMeshComponent* AGridActor::GetTileChunkComponent(const int32 TileId) const
+{
+	return ChunkComponents[TileStore.GetChunkId(TileId)];
+}
+
+void AGridActor::AddTilesToChunk(const int32 ChunkId, const TArray<int32>& TileIds, const TArray<FTransform>& TileTransforms,
+	const TArray<int32>& MovementCosts, const TArray<uint8>& AllowedMovement, const TArray<int32>& Heights)
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridInstanceUpdates);
+	if(TileIds.IsEmpty())
+	{
+		return;
+	}
+	const TArray<int32> InstanceIndices = GetOrCreateChunkComponent(ChunkId)->AddInstances(TileTransforms, true);
+	INC_DWORD_STAT_BY(STAT_GridInstanceWrites, TileIds.Num());
+	for(int32 i = 0; i < TileIds.Num(); i++)
+	{
+		if(Heights.IsEmpty())
+		{
+			TileStore.AddTile(TileIds[i], InstanceIndices[i], MovementCosts[i], AllowedMovement[i]);
+		}
+		else
+		{
+			TileStore.AddTile(TileIds[i], InstanceIndices[i], MovementCosts[i], AllowedMovement[i], Heights[i]);
+		}
+		TileStore.SetElevation(TileIds[i], TileTransforms[i].GetLocation().Z);
+	}
+}
+
+void AGridActor::CancelGridGeneration()
+{
+	//Bumping the id makes every trace still in flight ignore its result
+	const uint32 NextRequestId = PendingGeneration.RequestId + 1;
+	PendingGeneration = FGridGenerationRequest{NextRequestId};
 }
 
 void AGridActor::DestroyGrid()
 {
+	CancelGridGeneration();
 	InstancedStaticMeshComponent->ClearInstances();
-	GridIndexToInstanceIndex.Empty();
-	TileDataMap.Empty();
+	for(UHierarchicalInstancedStaticMeshComponent* ChunkComponent : ChunkComponents)
+	{
+		if(ChunkComponent != nullptr)
+		{
+			ChunkComponent->DestroyComponent();
+		}
+	}
+	ChunkComponents.Empty();
+	Simulation.Reset();
+	TileStore.Reset();
+	TileHighlights.Init(0);
+	OccupantCharacters.Empty();
+#if WITH_EDITORONLY_DATA
+	TileInspectionView.Empty();
+#endif
 	const auto* Controller = UGameplayStatics::GetPlayerController(GetWorld(), 0);
 	if(Controller != nullptr)
 	{
@@ -135,89 +520,106 @@ void AGridActor::DestroyGrid()
 bool AGridActor::TraceForGround(FVector TraceStartLocation, FVector& TraceHitLocation, FGridModifierVolumeData& HitVolumeData) const
 {
 	TArray<FHitResult> TraceHits{};
-	constexpr float TraceRadius = 50.f;
-	const bool bHit = UKismetSystemLibrary::SphereTraceMulti(GetWorld(), TraceStartLocation, TraceStartLocation-FVector{0,0,1000}, TraceRadius, UEngineTypes::ConvertToTraceType(ECC_GameTraceChannel1), false, TArray<AActor*>{}, EDrawDebugTrace::None, TraceHits, true );
-	if(bHit)
+	INC_DWORD_STAT(STAT_GridTracesIssued);
+	UKismetSystemLibrary::SphereTraceMulti(GetWorld(), TraceStartLocation, TraceStartLocation-FVector{0,0,GroundTraceDepth}, GroundTraceRadius, UEngineTypes::ConvertToTraceType(ECC_GameTraceChannel1), false, TArray<AActor*>{}, EDrawDebugTrace::None, TraceHits, true );
+	return ResolveGroundHits(TraceHits, TraceHitLocation, HitVolumeData);
+}
+
+bool AGridActor::ResolveGroundHits(const TArray<FHitResult>& TraceHits, FVector& TraceHitLocation, FGridModifierVolumeData& HitVolumeData)
+{
+	if(TraceHits.IsEmpty())
+	{
+		return false;
+	}
+	const auto* ModifierVolume = Cast<AGridModifierVolume>(TraceHits[0].GetActor());
+	if(ModifierVolume != nullptr)
 	{
-		const auto* ModifierVolume = Cast<AGridModifierVolume>(TraceHits[0].GetActor());
-		if(ModifierVolume != nullptr)
+		if(ModifierVolume->DoesBlockAllMovement())
 		{
-			if(ModifierVolume->DoesBlockAllMovement())
-			{
-				return false;
-			}
-			HitVolumeData = ModifierVolume->GetVolumeSettings();
+			return false;
 		}
-		TraceHitLocation = TraceHits[0].Location - FVector(0,0, TraceRadius);
+		HitVolumeData = ModifierVolume->GetVolumeSettings();
 	}
-	return bHit;
+	TraceHitLocation = TraceHits[0].Location - FVector(0,0, GroundTraceRadius);
+	return true;
 }
 
-void AGridActor::RetracePathFromIndex(const FIntVector2& IntVector2, TArray<FIntVector2>& Array) const
+bool AGridActor::FindPath(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath,
+                          const uint8 UnitMovementType, const int UnitJumpPower) const
 {
-	Array.Empty();
-	Array.Emplace(IntVector2);
-	UTileData* CurrentTile = TileDataMap.FindChecked(IntVector2);
-	while(CurrentTile->GetConnectedTile().IsSet())
+	OutPath.Reset();
+	if(!IsTileReachable(StartIndex, TargetIndex, UnitMovementType, UnitJumpPower))
 	{
-		auto Index = CurrentTile->GetConnectedTile().GetValue();
-		Array.Emplace(Index);
-		CurrentTile = TileDataMap.FindChecked(Index);
+		return false;
 	}
-	Algo::Reverse(Array);
+	return FindPathWithContext(SearchContext, StartIndex, TargetIndex, OutPath, UnitMovementType, UnitJumpPower);
 }
 
-bool AGridActor::FindPath(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath,
-                          const uint8 UnitMovementType, const int UnitJumpPower, TMap<FIntVector2, UTileData*> TileSetData) const
+bool AGridActor::IsTileReachable(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, const uint8 UnitMovementType, const int UnitJumpPower) const
 {
-	if(TileSetData.IsEmpty())
+	if(!ContainsTileWithIndex(StartIndex) || !ContainsTileWithIndex(TargetIndex))
 	{
-		TileSetData = TileDataMap;
+		return false;
 	}
-	OutPath.Empty();
-	TArray<FIntVector2> OpenList{};
-	OpenList.AddUnique(StartIndex);
-	TArray<FIntVector2> ClosedList{};
-	for (auto& [Index, Tile] : TileSetData)
+	return GetComponentLabels(UnitMovementType, UnitJumpPower).CanReach(TileStore, TileStore.ToTileId(StartIndex), TileStore.ToTileId(TargetIndex));
+}
+
+FGridComponentLabels& AGridActor::GetComponentLabels(const uint8 UnitMovementType, const int UnitJumpPower) const
+{
+	const uint64 RulesKey = GetMovementRulesKey(UnitMovementType, UnitJumpPower);
+	FGridComponentLabels* Labels = ComponentLabels.Find(RulesKey);
+	if(Labels == nullptr)
 	{
-		Tile->ResetConnectedTile();
-		Tile->SetGValue(MAX_int32);
+		Labels = &ComponentLabels.Emplace(RulesKey, FGridComponentLabels{UnitMovementType, UnitJumpPower});
 	}
-	auto* StartNode = TileSetData.FindChecked(StartIndex);
-	StartNode->SetGValue(0);
-	StartNode->SetHValue(GetDistanceBetweenTiles(StartIndex,TargetIndex));
+	return *Labels;
+}
 
-	while(!OpenList.IsEmpty())
+bool AGridActor::FindPathWithContext(FGridSearchContext& Context, const FIntVector2& StartIndex, const FIntVector2& TargetIndex,
+	TArray<FIntVector2>& OutPath, const uint8 UnitMovementType, const int UnitJumpPower, const FGridTileFilter& TileFilter) const
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridFindPath);
+	OutPath.Reset();
+	const FGridMovementGraph Graph{TileStore, UnitMovementType, UnitJumpPower, TileFilter};
+	if(!Graph.IsSearchable(StartIndex) || !Graph.IsSearchable(TargetIndex))
 	{
-		FIntVector2 CurrentIndex = GetLowestFValueTileIndex(OpenList);
-		if(CurrentIndex == TargetIndex)
-		{
-			OpenList.Empty();
-			RetracePathFromIndex(TargetIndex, OutPath);
-			return true;
-		}
-		OpenList.Remove(CurrentIndex);
-		ClosedList.AddUnique(CurrentIndex);
-		TArray<FIntVector2> Neighbors;
-		GetWalkableNeighbors(CurrentIndex,Neighbors, UnitMovementType, UnitJumpPower, TileSetData);
-		for (auto& Index : Neighbors)
-		{
-			if(ClosedList.Contains(Index))
-			{
-				continue;
-			}
-			const int TentativeGValue = GetTileGValueByIndex(CurrentIndex) + GetTileMovementCost(Index, UnitMovementType & static_cast<uint8>(EGridMovementType::Aerial));
-			if(TentativeGValue < GetTileGValueByIndex(Index))
-			{
-				auto* TargetTile = TileSetData.FindChecked(Index);
-				TargetTile->SetConnectedTile(CurrentIndex);
-				TargetTile->SetGValue(TentativeGValue);
-				TargetTile->SetHValue(GetDistanceBetweenTiles(Index,TargetIndex));
-				OpenList.AddUnique(Index);
-			}
-		}
+		return false;
 	}
-	return false;
+	return GridPathfinding::FindPath(Graph, Context, Graph.ToTileId(StartIndex), Graph.ToTileId(TargetIndex), OutPath);
+}
+
+bool AGridActor::FindPathIncremental(FGridPathPlanner& Planner, const FIntVector2& StartIndex, const FIntVector2& TargetIndex,
+	TArray<FIntVector2>& OutPath, const uint8 UnitMovementType, const int UnitJumpPower) const
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridFindPathIncremental);
+	OutPath.Reset();
+	if(!ContainsTileWithIndex(StartIndex) || !ContainsTileWithIndex(TargetIndex))
+	{
+		return false;
+	}
+	return Planner.FindPath(TileStore, TileStore.ToTileId(StartIndex), TileStore.ToTileId(TargetIndex), UnitMovementType, UnitJumpPower, OutPath);
+}
+
+bool AGridActor::FindPathHierarchical(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath,
+	const uint8 UnitMovementType, const int UnitJumpPower) const
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridFindPathHierarchical);
+	OutPath.Reset();
+	if(GetDistanceBetweenTiles(StartIndex, TargetIndex) <= 2 * FGridPathHierarchy::ClusterSize)
+	{
+		return FindPath(StartIndex, TargetIndex, OutPath, UnitMovementType, UnitJumpPower);
+	}
+	if(!IsTileReachable(StartIndex, TargetIndex, UnitMovementType, UnitJumpPower))
+	{
+		return false;
+	}
+	const uint64 HierarchyKey = GetMovementRulesKey(UnitMovementType, UnitJumpPower);
+	FGridPathHierarchy* Hierarchy = PathHierarchies.Find(HierarchyKey);
+	if(Hierarchy == nullptr)
+	{
+		Hierarchy = &PathHierarchies.Emplace(HierarchyKey, FGridPathHierarchy{UnitMovementType, UnitJumpPower});
+	}
+	return Hierarchy->FindPath(TileStore, SearchContext, TileStore.ToTileId(StartIndex), TileStore.ToTileId(TargetIndex), OutPath);
 }
 
 void AGridActor::GetWalkableTilesInRange(const FIntVector2& StartIndex, const int MovementRange,TArray<FIntVector2>& OutRange,
@@ -228,33 +630,36 @@ void AGridActor::GetWalkableTilesInRange(const FIntVector2& StartIndex, const in
 	{
 		return;
 	}
-	GetAllTilesInRange(StartIndex,MovementRange,OutRange);
-	if(OutRange.IsEmpty())
+	FGridMovementRange MovementRangeData;
+	GetMovementRange(StartIndex, MovementRange, MovementRangeData, UnitMovementType, UnitJumpPower);
+	OutRange = MoveTemp(MovementRangeData.Tiles);
+}
+
+void AGridActor::GetMovementRange(const FIntVector2& StartIndex, const int MovementRange, FGridMovementRange& OutRange,
+	const uint8 UnitMovementType, const int UnitJumpPower) const
+{
+	const FGridRangeQueryKey Key = MakeRangeQueryKey(StartIndex, MovementRange, UnitMovementType, UnitJumpPower);
+	if(const FGridMovementRange* CachedRange = RangeCache.FindAndTouch(Key))
 	{
+		OutRange = *CachedRange;
 		return;
 	}
-	TMap<FIntVector2, UTileData*> RangeDataSet {};
-	RangeDataSet.Reserve(OutRange.Num());
-	TArray<FIntVector2> AuxRange{};
-	for(auto Index : OutRange)
-	{
-		if(this->ContainsTileWithIndex(Index))
-		{
-			RangeDataSet.Emplace(Index, TileDataMap.FindChecked(Index));
-		}
-	}
-	TArray<FIntVector2> AuxPath{};
-	for(auto Index : OutRange)
+	GetMovementRange(SearchContext, StartIndex, MovementRange, OutRange, UnitMovementType, UnitJumpPower);
+	RangeCache.Add(Key, OutRange);
+}
+
+void AGridActor::GetMovementRange(FGridSearchContext& Context, const FIntVector2& StartIndex, const int MovementRange,
+	FGridMovementRange& OutRange, const uint8 UnitMovementType, const int UnitJumpPower) const
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridMovementRange);
+	OutRange.Reset();
+	if(!ContainsTileWithIndex(StartIndex))
 	{
-		if(FindPath(StartIndex,Index, AuxPath, UnitMovementType, UnitJumpPower, RangeDataSet ))
-		{
-			if( CalculatePathingCost(AuxPath, UnitMovementType & static_cast<uint8>(EGridMovementType::Aerial)) <= MovementRange)
-			{
-				AuxRange.Emplace(Index);
-			}
-		}
+		return;
 	}
-	OutRange = AuxRange;
+	//Every tile costs at least one to enter, so a cost-bounded fill never leaves the range diamond GetAllTilesInRange used to build
+	const FGridMovementGraph Graph{TileStore, UnitMovementType, UnitJumpPower};
+	GridPathfinding::FindReachableTiles(Graph, Context, Graph.ToTileId(StartIndex), MovementRange, OutRange);
 }
 
 int AGridActor::CalculatePathingCost(TArray<FIntVector2>& Path, bool bUnhinderedByTerrain) const
@@ -267,15 +672,6 @@ int AGridActor::CalculatePathingCost(TArray<FIntVector2>& Path, bool bUnhindered
 	return Result;
 }
 
-int AGridActor::GetTileGValueByIndex(const FIntVector2& TileIndex) const
-{
-	if(!ContainsTileWithIndex(TileIndex))
-	{
-		return INT_MAX;
-	}
-	return TileDataMap.FindChecked(TileIndex)->GetGValue();
-}
-
 int AGridActor::GetTileMovementCost(const FIntVector2& TileIndex, bool bUnhinderedByTerrain) const
 {
 	if(!ContainsTileWithIndex(TileIndex))
@@ -286,23 +682,7 @@ int AGridActor::GetTileMovementCost(const FIntVector2& TileIndex, bool bUnhinder
 	{
 		return 1;
 	}
-	return TileDataMap.FindChecked(TileIndex)->GetMovementCost();
-}
-
-FIntVector2 AGridActor::GetLowestFValueTileIndex(const TArray<FIntVector2>& GroupToSearch) const
-{
-	FIntVector2 LowestFValueIndex = GroupToSearch[0];
-	int LowestFValue = TileDataMap.FindChecked(LowestFValueIndex)->GetFValue();
-	for(auto& Index : GroupToSearch)
-	{
-		const auto* Tile = TileDataMap.FindChecked(Index);
-		if(Tile->GetFValue() < LowestFValue)
-		{
-			LowestFValue = Tile->GetFValue();
-			LowestFValueIndex = Index;
-		}
-	}
-	return  LowestFValueIndex;
+	return TileStore.GetMovementCost(TileStore.ToTileId(TileIndex));
 }
 
 int AGridActor::GetDistanceBetweenTiles(const FIntVector2& TileAIndex, const FIntVector2& TileBIndex)
@@ -313,21 +693,25 @@ int AGridActor::GetDistanceBetweenTiles(const FIntVector2& TileAIndex, const FIn
 }
 
 void AGridActor::GetAllTilesInRange(const FIntVector2& StartIndex, const int MovementRange,
-	TArray<FIntVector2>& OutRange, TMap<FIntVector2, UTileData*> TileSetData) const
+	TArray<FIntVector2>& OutRange, const FGridTileFilter& TileFilter) const
 {
-	if(TileSetData.IsEmpty())
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridShapeQuery);
+	OutRange.Reset();
+	if(TileFilter.IsUnrestricted() && MovementRange >= 0 && MovementRange <= FGridShapeStencil::MaxRadius)
 	{
-		TileSetData = TileDataMap;
+		GetTilesInShape(EGridShapeType::Diamond, StartIndex, MovementRange, OutRange);
+		return;
 	}
-	OutRange.Empty();
+	//Only walk the diamond itself, every offset is visited once so no uniqueness check is needed
 	for(int i = -MovementRange; i <= MovementRange;i++)
 	{
-		for(int j = -MovementRange;j <= MovementRange;j++)
+		const int RowRange = MovementRange - FMath::Abs(i);
+		for(int j = -RowRange;j <= RowRange;j++)
 		{
 			const FIntVector2 TentativeIndex {StartIndex.X+i, StartIndex.Y+j};
-			if(TileSetData.Contains(TentativeIndex) && GetDistanceBetweenTiles(StartIndex,TentativeIndex) <= MovementRange)
+			if(TileStore.HasTile(TentativeIndex) && TileFilter.Accepts(TileStore, TileStore.ToTileId(TentativeIndex)))
 			{
-				OutRange.AddUnique(TentativeIndex);
+				OutRange.Emplace(TentativeIndex);
 			}
 		}
 	}
@@ -335,64 +719,336 @@ void AGridActor::GetAllTilesInRange(const FIntVector2& StartIndex, const int Mov
 
 void AGridActor::AddTileAt(const FTransform& TileTransform, const FIntVector2& GridIndex, const FGridModifierVolumeData InTileSettings)
 {
-	const int InstanceIndex = InstancedStaticMeshComponent->GetInstanceCount();
-	UTileData* TileData = NewObject<UTileData>();
-	TileData->SetMovementCost(InTileSettings.ModifiedMovementCost);
-	TileData->SetAllowedMovementTypes(InTileSettings.VolumeAllowedMovement);
-	TileData->SetInstanceIndex(InstanceIndex);
-	GridIndexToInstanceIndex.Add(GridIndex, InstanceIndex);
-	InstancedStaticMeshComponent->AddInstance(TileTransform);
-	TileDataMap.Add(GridIndex,TileData);
+	if(!TileStore.IsInBounds(GridIndex))
+	{
+		return;
+	}
+	const int32 TileId = TileStore.ToTileId(GridIndex);
+	RemoveTileAt(GridIndex);
+	const int InstanceIndex = GetOrCreateChunkComponent(TileStore.GetChunkId(TileId))->AddInstance(TileTransform);
+	INC_DWORD_STAT(STAT_GridInstanceWrites);
+	TileStore.AddTile(TileId, InstanceIndex, InTileSettings.ModifiedMovementCost, InTileSettings.VolumeAllowedMovement);
+	TileStore.SetElevation(TileId, TileTransform.GetLocation().Z);
 }
 
 bool AGridActor::RemoveTileAt(const FIntVector2& GridIndexToRemove)
 {
-	if(!GridIndexToInstanceIndex.Contains(GridIndexToRemove))
+	if(!ContainsTileWithIndex(GridIndexToRemove))
 	{
 		return false;
 	}
-	const int TargetIndex = GridIndexToInstanceIndex.FindAndRemoveChecked(GridIndexToRemove);
-	TileDataMap.FindAndRemoveChecked(GridIndexToRemove);
-	InstancedStaticMeshComponent->RemoveInstance(TargetIndex);
+	const int32 TileId = TileStore.ToTileId(GridIndexToRemove);
+	const int32 ChunkId = TileStore.GetChunkId(TileId);
+	const int TargetIndex = TileStore.GetInstanceIndex(TileId);
+	TileStore.RemoveTile(TileId);
+	TileHighlights.Forget(TileId);
+	UHierarchicalInstancedStaticMeshComponent* ChunkComponent = ChunkComponents[ChunkId];
+	ChunkComponent->RemoveInstance(TargetIndex);
+	INC_DWORD_STAT(STAT_GridInstanceWrites);
+	//Hierarchical instance components fill the hole with their last instance
+	const int32 MovedInstanceIndex = ChunkComponent->GetInstanceCount();
+	if(MovedInstanceIndex != TargetIndex)
+	{
+		const int32 MovedTileId = TileStore.FindTileByInstance(ChunkId, MovedInstanceIndex);
+		if(MovedTileId != INDEX_NONE)
+		{
+			TileStore.SetInstanceIndex(MovedTileId, TargetIndex);
+		}
+	}
 	return true;
 }
 
 void AGridActor::HighlightTile(const FIntVector2& GridIndex)
 {
-	const int TargetTile = *GridIndexToInstanceIndex.Find(GridIndex);
-	InstancedStaticMeshComponent->SetCustomDataValue(TargetTile, 0, 1,true);
+	TileHighlights.Set(TileStore.ToTileId(GridIndex), true);
 	ApplyStateToTile(GridIndex,static_cast<int>(ETileState::Hovered) );
 }
 
 void AGridActor::UnlightTile(const FIntVector2& GridIndex)
 {
-	const int TargetTile = *GridIndexToInstanceIndex.Find(GridIndex);
-	InstancedStaticMeshComponent->SetCustomDataValue(TargetTile, 0, 0, true);
+	TileHighlights.Set(TileStore.ToTileId(GridIndex), false);
 	RemoveStateFromTile(GridIndex, static_cast<int>(ETileState::Hovered));
 }
 
 void AGridActor::UnlightAllTiles()
 {
-	for(auto& [Index, Tile] : TileDataMap)
+	//Only highlighted tiles can be hovered, everything else is already unlit
+	TArray<int32> LitTiles{};
+	for(TConstSetBitIterator<> It(TileHighlights.Requested); It; ++It)
+	{
+		LitTiles.Add(It.GetIndex());
+	}
+	for(const int32 TileId : LitTiles)
+	{
+		UnlightTile(TileStore.ToGridIndex(TileId));
+	}
+}
+
+void AGridActor::FlushTileHighlights()
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridHighlightFlush);
+	if(TileHighlights.QueuedTiles.IsEmpty())
+	{
+		return;
+	}
+	TBitArray<> DirtyChunks{false, TileStore.GetNumChunks()};
+	int32 NumTileWrites = 0;
+	for(const int32 TileId : TileHighlights.QueuedTiles)
+	{
+		TileHighlights.Queued[TileId] = false;
+		const bool bHighlighted = TileHighlights.Requested[TileId];
+		//Toggled back within the frame, or removed since it was queued
+		if(TileHighlights.Rendered[TileId] == bHighlighted || !TileStore.HasTile(TileId))
+		{
+			continue;
+		}
+		TileHighlights.Rendered[TileId] = bHighlighted;
+		const int32 ChunkId = TileStore.GetChunkId(TileId);
+		ChunkComponents[ChunkId]->SetCustomDataValue(TileStore.GetInstanceIndex(TileId), 0, bHighlighted ? 1.f : 0.f, false);
+		DirtyChunks[ChunkId] = true;
+		++NumTileWrites;
+	}
+	TileHighlights.QueuedTiles.Reset();
+
+	int32 NumChunkUploads = 0;
+	for(TConstSetBitIterator<> It(DirtyChunks); It; ++It)
+	{
+		ChunkComponents[It.GetIndex()]->MarkRenderStateDirty();
+		++NumChunkUploads;
+	}
+	INC_DWORD_STAT_BY(STAT_GridHighlightTileWrites, NumTileWrites);
+	INC_DWORD_STAT_BY(STAT_GridHighlightChunkUploads, NumChunkUploads);
+}
+
+FGridSnapshotRef AGridActor::GetTileSnapshot() const
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridSnapshot);
+	check(IsInGameThread());
+	if(!TileSnapshot.IsValid() || TileSnapshot->GetRevision() != TileStore.GetRevision())
+	{
+		//Workers still reading the previous snapshot keep it alive, chunks that did not change are shared with it
+		TileSnapshot = FGridSnapshot::Create(TileStore, TileSnapshot.Get());
+	}
+	return TileSnapshot.ToSharedRef();
+}
+
+TFuture<FGridPathResult> AGridActor::RequestPath(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, const uint8 UnitMovementType,
+	const int UnitJumpPower, const FGridQueryToken& Token) const
+{
+	return Async(EAsyncExecution::TaskGraph, [Snapshot = GetTileSnapshot(), StartIndex, TargetIndex, UnitMovementType, UnitJumpPower, Token]()
+	{
+		return GridAsyncQuery::RunPathQuery(*Snapshot, StartIndex, TargetIndex, UnitMovementType, UnitJumpPower, Token);
+	});
+}
+
+void AGridActor::RequestPath(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TUniqueFunction<void(FGridPathResult&&)>&& OnComplete,
+	const uint8 UnitMovementType, const int UnitJumpPower, const FGridQueryToken& Token)
+{
+	Async(EAsyncExecution::TaskGraph, [Snapshot = GetTileSnapshot(), StartIndex, TargetIndex, UnitMovementType, UnitJumpPower, Token,
+		WeakThis = TWeakObjectPtr<AGridActor>(this), OnComplete = MoveTemp(OnComplete)]() mutable
+	{
+		FGridPathResult Result = GridAsyncQuery::RunPathQuery(*Snapshot, StartIndex, TargetIndex, UnitMovementType, UnitJumpPower, Token);
+		if(Result.bCancelled)
+		{
+			return;
+		}
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Token, Result = MoveTemp(Result), OnComplete = MoveTemp(OnComplete)]() mutable
+		{
+			if(WeakThis.IsValid() && !GridAsyncQuery::IsCancelled(Token))
+			{
+				OnComplete(MoveTemp(Result));
+			}
+		});
+	});
+}
+
+TFuture<FGridRangeResult> AGridActor::RequestMovementRange(const FIntVector2& StartIndex, const int MovementRange, const uint8 UnitMovementType,
+	const int UnitJumpPower, const FGridQueryToken& Token) const
+{
+	return Async(EAsyncExecution::TaskGraph, [Snapshot = GetTileSnapshot(), StartIndex, MovementRange, UnitMovementType, UnitJumpPower, Token]()
+	{
+		return GridAsyncQuery::RunRangeQuery(*Snapshot, StartIndex, MovementRange, UnitMovementType, UnitJumpPower, Token);
+	});
+}
+
+void AGridActor::RequestMovementRange(const FIntVector2& StartIndex, const int MovementRange, TUniqueFunction<void(FGridRangeResult&&)>&& OnComplete,
+	const uint8 UnitMovementType, const int UnitJumpPower, const FGridQueryToken& Token)
+{
+	const FGridRangeQueryKey Key = MakeRangeQueryKey(StartIndex, MovementRange, UnitMovementType, UnitJumpPower);
+	if(const FGridMovementRange* CachedRange = RangeCache.FindAndTouch(Key))
+	{
+		if(!GridAsyncQuery::IsCancelled(Token))
+		{
+			FGridRangeResult Result;
+			Result.Range = *CachedRange;
+			OnComplete(MoveTemp(Result));
+		}
+		return;
+	}
+	Async(EAsyncExecution::TaskGraph, [Snapshot = GetTileSnapshot(), StartIndex, MovementRange, UnitMovementType, UnitJumpPower, Token, Key,
+		WeakThis = TWeakObjectPtr<AGridActor>(this), OnComplete = MoveTemp(OnComplete)]() mutable
+	{
+		FGridRangeResult Result = GridAsyncQuery::RunRangeQuery(*Snapshot, StartIndex, MovementRange, UnitMovementType, UnitJumpPower, Token);
+		if(Result.bCancelled)
+		{
+			return;
+		}
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Token, Key, Result = MoveTemp(Result), OnComplete = MoveTemp(OnComplete)]() mutable
+		{
+			if(!WeakThis.IsValid())
+			{
+				return;
+			}
+			//The snapshot was taken with the key, so the range stays valid for it even if the grid changed meanwhile
+			WeakThis->RangeCache.Add(Key, Result.Range);
+			if(!GridAsyncQuery::IsCancelled(Token))
+			{
+				OnComplete(MoveTemp(Result));
+			}
+		});
+	});
+}
+
+TFuture<FGridAIAction> AGridActor::RequestAIAction(TArray<FGridAIUnit> Units, const int32 Team, const FGridAIScoring& Scoring) const
+{
+	return Async(EAsyncExecution::TaskGraph, [Snapshot = GetTileSnapshot(), Units = MoveTemp(Units), Team, Scoring]()
+	{
+		return FGridTacticalAI::FindBestAction(*Snapshot, Units, Team, Scoring);
+	});
+}
+
+void AGridActor::SetDistanceFieldSources(const int32 TeamId, const TArray<FIntVector2>& SourceTiles, const uint8 UnitMovementType, const int UnitJumpPower)
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridDistanceFieldUpdate);
+	TArray<int32> SourceTileIds{};
+	SourceTileIds.Reserve(SourceTiles.Num());
+	for(const FIntVector2& SourceIndex : SourceTiles)
+	{
+		if(ContainsTileWithIndex(SourceIndex))
+		{
+			SourceTileIds.Add(TileStore.ToTileId(SourceIndex));
+		}
+	}
+	const uint64 FieldKey = GetDistanceFieldKey(TeamId, UnitMovementType, UnitJumpPower);
+	FGridDistanceField* Field = DistanceFields.Find(FieldKey);
+	if(Field == nullptr)
+	{
+		Field = &DistanceFields.Emplace(FieldKey, FGridDistanceField{UnitMovementType, UnitJumpPower});
+	}
+	Field->SetSources(TileStore, SourceTileIds);
+}
+
+void AGridActor::MoveDistanceFieldSource(const int32 TeamId, const FIntVector2& FromIndex, const FIntVector2& ToIndex, const uint8 UnitMovementType, const int UnitJumpPower)
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridDistanceFieldUpdate);
+	FGridDistanceField* Field = DistanceFields.Find(GetDistanceFieldKey(TeamId, UnitMovementType, UnitJumpPower));
+	if(Field == nullptr || !ContainsTileWithIndex(FromIndex) || !ContainsTileWithIndex(ToIndex))
+	{
+		return;
+	}
+	Field->MoveSource(TileStore, TileStore.ToTileId(FromIndex), TileStore.ToTileId(ToIndex));
+}
+
+int AGridActor::SampleDistanceField(const int32 TeamId, const FIntVector2& TileIndex, const uint8 UnitMovementType, const int UnitJumpPower) const
+{
+	FGridDistanceField* Field = DistanceFields.Find(GetDistanceFieldKey(TeamId, UnitMovementType, UnitJumpPower));
+	if(Field == nullptr || !TileStore.IsInBounds(TileIndex))
 	{
-		UnlightTile(Index);
+		return -1;
 	}
+	const int16 Distance = Field->GetDistance(TileStore, TileStore.ToTileId(TileIndex));
+	return Distance != FGridDistanceField::Unreachable ? Distance : -1;
+}
+
+void AGridActor::GetTilesInShape(const EGridShapeType Shape, const FIntVector2& Center, const int Radius, TArray<FIntVector2>& OutTiles,
+	const EGridDirection Direction, const int InnerRadius, const int MaxHeightDelta) const
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridShapeQuery);
+	OutTiles.Reset();
+	const FGridShapeStencil Stencil = FGridShapeStencil::Make(Shape, Radius, Direction, InnerRadius);
+	TArray<int32, TInlineAllocator<256>> TileIds{};
+	TileIds.SetNumUninitialized(Stencil.GetNumTiles());
+	TileIds.SetNum(GridShapeQuery::FindTiles(TileStore, Stencil, Center, TileIds, MaxHeightDelta));
+	OutTiles.Reserve(TileIds.Num());
+	for(const int32 TileId : TileIds)
+	{
+		OutTiles.Emplace(TileStore.ToGridIndex(TileId));
+	}
+}
+
+bool AGridActor::HasLineOfSight(const FIntVector2& From, const FIntVector2& To, const int EyeHeight, const int TargetHeight) const
+{
+	return GridVisibility::HasLineOfSight(TileStore, From, To, EyeHeight, TargetHeight);
+}
+
+void AGridActor::GetVisibleTiles(const FIntVector2& Origin, const int Radius, TArray<FIntVector2>& OutVisibleTiles, const int EyeHeight, const int TargetHeight) const
+{
+	OutVisibleTiles.Reset();
+	GetFieldOfView({Origin, Radius, EyeHeight, TargetHeight})->ForEachVisibleTile([&OutVisibleTiles](const FIntVector2& TileIndex)
+	{
+		OutVisibleTiles.Emplace(TileIndex);
+	});
+}
+
+FGridFieldOfViewRef AGridActor::GetFieldOfView(const FGridSightQuery& Query) const
+{
+	return VisibilityCache.GetFieldOfView(TileStore, Query);
+}
+
+void AGridActor::GetFieldsOfView(const TArrayView<const FGridSightQuery> Queries, TArray<FGridFieldOfViewRef>& OutFieldsOfView) const
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridFieldsOfView);
+	VisibilityCache.GetFieldsOfView(*GetTileSnapshot(), Queries, OutFieldsOfView);
+}
+
+const TArray<int16>* AGridActor::GetDistanceField(const int32 TeamId, const uint8 UnitMovementType, const int UnitJumpPower) const
+{
+	FGridDistanceField* Field = DistanceFields.Find(GetDistanceFieldKey(TeamId, UnitMovementType, UnitJumpPower));
+	return Field != nullptr ? &Field->GetDistances(TileStore) : nullptr;
+}
+
+void AGridActor::SetTileMovementCost(const FIntVector2& TileIndex, const int NewMovementCost)
+{
+	if(!ContainsTileWithIndex(TileIndex))
+	{
+		return;
+	}
+	TileStore.SetMovementCost(TileStore.ToTileId(TileIndex), NewMovementCost);
+}
+
+void AGridActor::SetTileAllowedMovement(const FIntVector2& TileIndex, const uint8 NewAllowedMovement)
+{
+	if(!ContainsTileWithIndex(TileIndex))
+	{
+		return;
+	}
+	TileStore.SetAllowedMovementTypes(TileStore.ToTileId(TileIndex), NewAllowedMovement);
+}
+
+void AGridActor::SetTileHeight(const FIntVector2& TileIndex, const int NewHeight)
+{
+	if(!ContainsTileWithIndex(TileIndex))
+	{
+		return;
+	}
+	TileStore.SetHeight(TileStore.ToTileId(TileIndex), NewHeight);
 }
 
 void AGridActor::ApplyStateToTile(const FIntVector2& TileIndex, const uint8 StateToAdd)
 {
-	UTileData* TileData = TileDataMap.FindChecked(TileIndex);
-	TileData->AddState(StateToAdd);
+	check(ContainsTileWithIndex(TileIndex));
+	TileStore.AddState(TileStore.ToTileId(TileIndex), StateToAdd);
 }
 
 void AGridActor::RemoveStateFromTile(const FIntVector2& TileIndex, const uint8 StateToRemove)
 {
-	UTileData* TileData = TileDataMap.FindChecked(TileIndex);
-	TileData->RemoveState(StateToRemove);
+	check(ContainsTileWithIndex(TileIndex));
+	TileStore.RemoveState(TileStore.ToTileId(TileIndex), StateToRemove);
 }
 
 FIntVector2 AGridActor::GetTileIndexByCursorPosition(int PlayerControllerIndex) const
 {
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridCursorPicking);
 	FVector ControllerCursorLocation;
 	FVector WorldDirection;
 	FHitResult TraceHit;
@@ -403,8 +1059,8 @@ FIntVector2 AGridActor::GetTileIndexByCursorPosition(int PlayerControllerIndex)
 	{
 		CursorProjectionInGrid = TraceHit.Location;
 	}
-	TArray<int32> InstancesNearCursorByIndex = InstancedStaticMeshComponent->GetInstancesOverlappingSphere(CursorProjectionInGrid, 20.f); 
-	if(InstancesNearCursorByIndex.IsEmpty())
+	const int32 HoveredTileId = bHit ? GetTileIdAtLocation(CursorProjectionInGrid) : INDEX_NONE;
+	if(HoveredTileId == INDEX_NONE)
 	{
 #if WITH_EDITOR
 		GEngine->AddOnScreenDebugMessage(0, 5, FColor::Yellow, FString::Format(TEXT("Player cursor at World Location: {0},{1},{2}. No tile at location"), {CursorProjectionInGrid.X, CursorProjectionInGrid.Y, CursorProjectionInGrid.Z}));
@@ -414,22 +1070,12 @@ FIntVector2 AGridActor::GetTileIndexByCursorPosition(int PlayerControllerIndex)
 		return {-1,-1}; //return negative index to represent no tile overlapped
 	}
 	
-	InstancesNearCursorByIndex.Sort([this, ControllerCursorLocation](const int32 IndexA, const int32 IndexB)
-	{
-		FTransform InstanceATransform;
-		FTransform InstanceBTransform;
-		InstancedStaticMeshComponent->GetInstanceTransform(IndexA,InstanceATransform, true);
-		InstancedStaticMeshComponent->GetInstanceTransform(IndexB,InstanceBTransform, true);
-		return FVector::Distance(InstanceATransform.GetLocation(), ControllerCursorLocation) > FVector::Distance(InstanceBTransform.GetLocation(), ControllerCursorLocation);
-	});
-	
-	auto& TileIndex = *GridIndexToInstanceIndex.FindKey(InstancesNearCursorByIndex[0]);
+	const FIntVector2 TileIndex = TileStore.ToGridIndex(HoveredTileId);
 #if WITH_EDITOR
 	GEngine->AddOnScreenDebugMessage(0, 5, FColor::Yellow, FString::Format(TEXT("Player cursor at World Location: {0},{1},{2}. Closest Tile: {3}, {4}"), {CursorProjectionInGrid.X, CursorProjectionInGrid.Y, CursorProjectionInGrid.Z, TileIndex.X, TileIndex.Y}));
-	auto* TargetTileData = *TileDataMap.Find(TileIndex);
 	TArray<FIntVector2> TileNeighborhood{};
 	GetTileNeighborhood(TileIndex, TileNeighborhood);
-	GEngine->AddOnScreenDebugMessage(1, 5, FColor::Yellow, FString::Format(TEXT("Data for tile - InstanceIndex : {0}. CurrentState: {1}. AllowedMovement: {2}"), {TargetTileData->GetInstanceIndex(), TargetTileData->GetTileState(), TargetTileData->GetAllowedMovementTypes()}));
+	GEngine->AddOnScreenDebugMessage(1, 5, FColor::Yellow, FString::Format(TEXT("Data for tile - InstanceIndex : {0}. CurrentState: {1}. AllowedMovement: {2}"), {TileStore.GetInstanceIndex(HoveredTileId), TileStore.GetTileState(HoveredTileId), TileStore.GetAllowedMovementTypes(HoveredTileId)}));
 	FString NeighborListString{TEXT("Tile neighbors: ")};
 	for(auto& Index : TileNeighborhood)
 	{
@@ -450,7 +1096,6 @@ void AGridActor::SelectHoveredTile()
 	
 	if(!IsTileSelected(HoveredTileIndex))
 	{
-		UnlightAllTiles();
 		// TArray<FIntVector2> Path;
 		// if(FindPath({0,0},HoveredTileIndex,Path, static_cast<uint8>(EGridMovementType::Ground)))
 		// {
@@ -460,91 +1105,83 @@ void AGridActor::SelectHoveredTile()
 		// 	}
 		// }
 
-		TArray<FIntVector2> Range;
-		GetWalkableTilesInRange(HoveredTileIndex,5,Range, static_cast<uint8>(EGridMovementType::Ground));
-		for (auto& Index : Range)
+		if(SelectionQueryToken.IsValid())
 		{
-			HighlightTile(Index);
+			SelectionQueryToken->Cancel();
 		}
+		SelectionQueryToken = MakeShared<FGridQueryCancellation, ESPMode::ThreadSafe>();
+		RequestMovementRange(HoveredTileIndex, 5, [this](FGridRangeResult&& Result)
+		{
+			UnlightAllTiles();
+			for (auto& Index : Result.Range.Tiles)
+			{
+				HighlightTile(Index);
+			}
+		}, static_cast<uint8>(EGridMovementType::Ground), INT_MAX, SelectionQueryToken);
 		ATacticalBattleCharacter* TestCharacter = Cast<ATacticalBattleCharacter>( UGameplayStatics::GetActorOfClass(GetWorld(), ATacticalBattleCharacter::StaticClass()));
 		PlaceCharacterInGrid(HoveredTileIndex, TestCharacter);
 	}
 }
 
-void AGridActor::GetTileNeighborhood(const FIntVector2& TileIndex, TArray<FIntVector2>& OutNeighborhood, TMap<FIntVector2, UTileData*> TileSetData) const
+void AGridActor::GetTileNeighborhood(const FIntVector2& TileIndex, TArray<FIntVector2>& OutNeighborhood, const FGridTileFilter& TileFilter) const
 {
-	if(TileSetData.IsEmpty())
-	{
-		TileSetData = TileDataMap;
-	}
 	if(TileIndex.X <0 || TileIndex.Y <0 || !this->ContainsTileWithIndex(TileIndex))
 	{
 		UE_LOG(LogTemp,Warning, TEXT("Referenced grid does not contain a tile with the provided index."))
 		return;
 	}
-	OutNeighborhood.Empty();
+	OutNeighborhood.Reset();
 	//(X-1,Y), (X+1,Y), (X,Y-1), (X,Y+1)
-	for(int i = -1;i <= 1; i++)
+	static constexpr int32 NeighborOffsets[4][2] {{-1,0},{1,0},{0,-1},{0,1}};
+	for(const auto& Offset : NeighborOffsets)
 	{
-		for(int j = -1;j <= 1; j++)
+		const FIntVector2 NeighborIndex {TileIndex.X+Offset[0],TileIndex.Y+Offset[1]};
+		if(TileStore.HasTile(NeighborIndex) && TileFilter.Accepts(TileStore, TileStore.ToTileId(NeighborIndex)))
 		{
-			if(i == j || i == -j)
-			{
-				continue;
-			}
-			FIntVector2 NeighborIndex {TileIndex.X+i,TileIndex.Y+j};
-			if(TileSetData.Contains(NeighborIndex) && NeighborIndex != TileIndex)
-			{
-				OutNeighborhood.AddUnique(NeighborIndex);
-			}
+			OutNeighborhood.Emplace(NeighborIndex);
 		}
 	}
 }
 
 void AGridActor::GetWalkableNeighbors(const FIntVector2& TileIndex, TArray<FIntVector2>& OutNeighborhood,
-	const uint8 MoveTypeToCheck, int JumpPower, TMap<FIntVector2, UTileData*> TileSetData) const
+	const uint8 MoveTypeToCheck, int JumpPower, const FGridTileFilter& TileFilter) const
 {
-	if(TileSetData.IsEmpty())
-	{
-		TileSetData = TileDataMap;
-	}
 	if(TileIndex.X <0 || TileIndex.Y <0 || !this->ContainsTileWithIndex(TileIndex))
 	{
 		UE_LOG(LogTemp,Warning, TEXT("Referenced grid does not contain a tile with the provided index."))
 		return;
 	}
-	OutNeighborhood.Empty();
-	for(int i = -1;i <= 1; i++)
+	OutNeighborhood.Reset();
+	const FGridMovementGraph Graph{TileStore, MoveTypeToCheck, JumpPower, TileFilter};
+	Graph.ForEachNeighbor(TileStore.ToTileId(TileIndex), [&](const int32 NeighborId)
 	{
-		for(int j = -1;j <= 1; j++)
-		{
-			if(i == j || i == -j)
-			{
-				continue;
-			}
-			FIntVector2 NeighborIndex {TileIndex.X+i,TileIndex.Y+j};
-			
-			if(TileSetData.Contains(NeighborIndex) && NeighborIndex != TileIndex)
-			{
-				const auto* NeighborTile = TileSetData.FindChecked(NeighborIndex);
-				const auto* OriginalTile = TileSetData.FindChecked(TileIndex);
-				
-				const bool bWalkable = NeighborTile->IsTileWalkable(MoveTypeToCheck);
-				const bool bEnoughJump = FMath::Abs(NeighborTile->GetTileHeight() - OriginalTile->GetTileHeight()) <= JumpPower;
-				
-				if(bWalkable && bEnoughJump)
-				{
-					OutNeighborhood.AddUnique(NeighborIndex);
-				}
-			}
-		}
-	}
+		OutNeighborhood.Emplace(TileStore.ToGridIndex(NeighborId));
+	});
 }
 
 bool AGridActor::IsTileSelected(const FIntVector2& TileIndex)
 {
-	const auto* TargetTileData = *TileDataMap.Find(TileIndex);
-	return TargetTileData->GetTileState() & static_cast<uint8>(ETileState::Selected);
+	return TileStore.GetTileState(TileStore.ToTileId(TileIndex)) & static_cast<uint8>(ETileState::Selected);
+}
+
+void AGridActor::RefreshTileInspectionView()
+{
+#if WITH_EDITORONLY_DATA
+	TileInspectionView.Empty(TileStore.GetNumTiles());
+	for(TConstSetBitIterator<> It(TileStore.GetTileMask()); It; ++It)
+	{
+		const int32 TileId = It.GetIndex();
+		UTileData* TileData = NewObject<UTileData>(this, NAME_None, RF_Transient);
+		TileData->SetInstanceIndex(TileStore.GetInstanceIndex(TileId));
+		TileData->SetMovementCost(TileStore.GetMovementCost(TileId));
+		TileData->SetHeight(TileStore.GetHeight(TileId));
+		TileData->SetTileState(TileStore.GetTileState(TileId));
+		TileData->SetAllowedMovementTypes(TileStore.GetAllowedMovementTypes(TileId));
+		const int32 OccupantHandle = TileStore.GetOccupant(TileId);
+		TileData->SetOccupantCharacter(OccupantCharacters.IsValidIndex(OccupantHandle) ? OccupantCharacters[OccupantHandle].Get() : nullptr);
+		TileInspectionView.Add(TileStore.ToGridIndex(TileId), TileData);
+	}
+#endif
 }
 
 // Called every frame
@@ -561,20 +1198,59 @@ void AGridActor::Tick(float DeltaTime)
 		}
 		
 		HoveredTileIndex = NewHoveredTileIndex;
-		if(HoveredTileIndex.X<0)
+		//Handle updating visuals of new selection if it exists
+		if(HoveredTileIndex.X>=0)
 		{
-			return;
+			HighlightTile(HoveredTileIndex);
 		}
-		//Handle updating visuals of new selection if it exists
-		HighlightTile(HoveredTileIndex);
-		
-		
 	}
-	
+	FlushTileHighlights();
+}
+
+int32 AGridActor::GetTileIdAtLocation(const FVector& WorldLocation) const
+{
+	if(GridStep <= 0.f)
+	{
+		return INDEX_NONE;
+	}
+	//Tiles sit on a regular GridStep lattice in actor space, so the column under a point is a rounding away
+	const FVector LocalLocation = GetActorTransform().InverseTransformPosition(WorldLocation);
+	const FIntVector2 TileIndex {FMath::RoundToInt(LocalLocation.X / GridStep), FMath::RoundToInt(LocalLocation.Y / GridStep)};
+	if(!TileStore.HasTile(TileIndex))
+	{
+		return INDEX_NONE;
+	}
+	const int32 TileId = TileStore.ToTileId(TileIndex);
+	//Reject points far above or below the tile surface of that column, e.g. a wall or a unit the cursor ray hit first
+	if(FMath::Abs(LocalLocation.Z - TileStore.GetElevation(TileId)) > GridStep)
+	{
+		return INDEX_NONE;
+	}
+	return TileId;
+}
+
+FIntVector2 AGridActor::GetTileIndexAtLocation(const FVector& WorldLocation) const
+{
+	const int32 TileId = GetTileIdAtLocation(WorldLocation);
+	return TileId != INDEX_NONE ? TileStore.ToGridIndex(TileId) : FIntVector2{-1,-1};
+}
+
+void AGridActor::SetHighlightedTiles(const TArray<FIntVector2>& TileIndices)
+{
+	//Tiles staying lit are toggled back within the batch and never written
+	UnlightAllTiles();
+	for(const FIntVector2& TileIndex : TileIndices)
+	{
+		if(ContainsTileWithIndex(TileIndex))
+		{
+			HighlightTile(TileIndex);
+		}
+	}
+	FlushTileHighlights();
 }
 
 bool AGridActor::ContainsTileWithIndex(const FIntVector2& TileIndex) const
 {
-	return GridIndexToInstanceIndex.Contains(TileIndex);
+	return TileStore.HasTile(TileIndex);
 }
 
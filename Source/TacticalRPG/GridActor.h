@@ -3,30 +3,32 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GridAsyncQuery.h"
+#include "GridBattleSimulation.h"
+#include "GridComponentLabels.h"
+#include "GridDistanceField.h"
+#include "GridPathfinding.h"
+#include "GridPathHierarchy.h"
+#include "GridPathPlanner.h"
+#include "GridShapeQuery.h"
+#include "GridTacticalAI.h"
+#include "GridTileStore.h"
 #include "GridUtilities.h"
+#include "GridVisibility.h"
+#include "Async/Future.h"
+#include "Containers/LruCache.h"
 #include "GameFramework/Actor.h"
 #include "GridActor.generated.h"
 
 struct FGridModifierVolumeData;
+struct FTraceHandle;
+struct FTraceDatum;
 
 
 
-USTRUCT()
-struct FPathData
-{
-	GENERATED_BODY()
-private:
-	
-	TOptional<FIntVector2> Connection {};
-
-	UPROPERTY(VisibleAnywhere)
-	int G{INT_MAX};
-	
-	UPROPERTY(VisibleAnywhere)
-	int H{0};
-
-	friend class UTileData;
-};
+/**
+ * Read-only copy of one tile of the grid's tile store, only built in the editor to inspect tile values on the actor.
+ */
 UCLASS()
 class UTileData : public UObject
 {
@@ -47,9 +49,6 @@ class UTileData : public UObject
 	UPROPERTY(VisibleAnywhere,meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.EGridMovementType"))
 	uint8 AllowedMovementTypes{ static_cast<uint8>(EGridMovementType::Any)};
 
-	UPROPERTY(VisibleAnywhere)
-	FPathData TilePathData;
-
 	UPROPERTY(VisibleAnywhere)
 	class ATacticalBattleCharacter* OccupantCharacter {nullptr};
 
@@ -104,16 +103,6 @@ public:
 		this->AllowedMovementTypes = InAllowedMovementTypes;
 	}
 
-	[[nodiscard]] const FPathData& GetTilePathData() const
-	{
-		return TilePathData;
-	}
-
-	void SetTilePathData(const FPathData& InTilePathData)
-	{
-		this->TilePathData = InTilePathData;
-	}
-
 	[[nodiscard]] ATacticalBattleCharacter* GetOccupantCharacter() const
 	{
 		return OccupantCharacter;
@@ -124,14 +113,6 @@ public:
 		this->OccupantCharacter = InOccupantCharacter;
 	}
 
-	TOptional<FIntVector2>& GetConnectedTile() {return TilePathData.Connection;}
-	void SetConnectedTile(const FIntVector2& InConnection) {TilePathData.Connection = InConnection;}
-	void ResetConnectedTile() {TilePathData.Connection.Reset();}
-	void SetGValue(const int32 InValue) {TilePathData.G = InValue;}
-	int& GetGValue() {return TilePathData.G;}
-	void SetHValue(const int32 InValue) {TilePathData.H = InValue;}
-	int& GetHValue() {return TilePathData.H;}
-	int GetFValue() const {return TilePathData.G + TilePathData.H;}
 	bool IsTileOccupied() const { return OccupantCharacter != nullptr;}
 	void AddState(const uint8 InState) {TileState |= InState;}
 	void RemoveState(const uint8 InState){TileState &= ~InState;}
@@ -157,6 +138,9 @@ enum class ETileState
 };
 ENUM_CLASS_FLAGS(ETileState);
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FGridGenerationProgress, float, Progress);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FGridGenerated);
+
 UCLASS()
 class TACTICALRPG_API AGridActor : public AActor
 {
@@ -169,6 +153,26 @@ public:
 	FIntVector2& GetHoveredTileIndex() {return HoveredTileIndex;};
 
 	void PlaceCharacterInGrid(const FIntVector2& TargetTile, ATacticalBattleCharacter* Character);
+
+	bool IsGeneratingGrid() const {return PendingGeneration.IsActive();}
+
+	void SetGridData(const TSoftObjectPtr<class UGridData>& InGridData) {GridData = InGridData;}
+	const FGridTileStore& GetTileStore() const {return TileStore;}
+	float GetGridStep() const {return GridStep;}
+
+	/** Tile whose column contains the world position, (-1,-1) if no tile surface is near it. What cursor picking resolves its hit to. */
+	UFUNCTION(BlueprintCallable, Category="Grid Management")
+	FIntVector2 GetTileIndexAtLocation(const FVector& WorldLocation) const;
+	/** Replaces every highlighted tile with TileIndices, only the tiles that changed are written to their chunks. */
+	UFUNCTION(BlueprintCallable, Category="Grid Management")
+	void SetHighlightedTiles(const TArray<FIntVector2>& TileIndices);
+
+	/** Fraction (0-1) of ground traces finished by the environment grid generation in flight. */
+	UPROPERTY(BlueprintAssignable)
+	FGridGenerationProgress OnGridGenerationProgress;
+
+	UPROPERTY(BlueprintAssignable)
+	FGridGenerated OnGridGenerated;
 	
 
 protected:
@@ -178,48 +182,261 @@ protected:
 	UPROPERTY(EditDefaultsOnly)
 	TSoftObjectPtr<class UGridData> GridData{nullptr};
 
+	/** Holds no tiles itself: its mesh, materials, custom data and collision settings are copied to every chunk component. */
 	UPROPERTY(VisibleAnywhere,BlueprintReadOnly)
 	TObjectPtr<class UInstancedStaticMeshComponent> InstancedStaticMeshComponent{nullptr};
 
+	/** One component per FGridTileStore chunk, so instance updates only re-upload the chunk they touch. Null until the chunk gets a tile. */
+	UPROPERTY(VisibleInstanceOnly, Transient)
+	TArray<TObjectPtr<class UHierarchicalInstancedStaticMeshComponent>> ChunkComponents{};
+
+	/** Distance from the camera past which chunk instances are culled, 0 keeps every chunk rendered. */
+	UPROPERTY(EditAnywhere, Category = "Grid Rendering", meta = (ClampMin = 0))
+	int32 ChunkCullDistance{0};
+
+public:
+	/** Restarts the environment grid generation, cancelling any generation still waiting on its traces. */
 	UFUNCTION(CallInEditor, Category = "Debug Utilities")
 	void RegenerateEnvironmentGrid();
 
+	UFUNCTION(BlueprintCallable, CallInEditor, Category = "Debug Utilities")
+	void CancelGridGeneration();
+
 	UFUNCTION(CallInEditor, Category = "Debug Utilities")
 	void RegenerateDefaultGrid();
 
+	/**
+	 * Traces again only the columns whose ground sweep can touch WorldBounds, then patches the tiles there in place:
+	 * instances move, tiles appear or disappear and costs and movement types follow the volumes now hit.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Grid Generation")
+	void RegenerateRegion(const FBox& WorldBounds);
+
+	/** Writes the current tiles to the baked grid file of GridData. Also runs after every environment generation in the editor. */
+	UFUNCTION(CallInEditor, Category = "Debug Utilities")
+	void BakeGrid();
+
+	/** Builds the grid from the baked file of GridData without tracing, false if there is no usable file. */
+	bool LoadBakedGrid();
+
+	/** Baked grid file saved next to the GridData asset. Add its folder to the non-asset directories to stage so packaged builds find it. */
+	FString GetBakedGridFilename() const;
+
+	/** Loads the baked grid on BeginPlay instead of tracing the level, falls back to tracing when there is none. */
+	UPROPERTY(EditAnywhere, Category = "Grid Generation")
+	bool bUseBakedGrid{true};
+
 	UFUNCTION(BlueprintCallable)
 	void SpawnGridAt(FVector SpawnLocation, bool bUseEnvironment = false, bool bUnspawnIfExists = true);
 
 	UFUNCTION(BlueprintCallable,CallInEditor, Category = "Debug Utilities")
 	void DestroyGrid();
 
+	/** Rebuilds the UTileData copies shown in the details panel from the current tile store. */
+	UFUNCTION(CallInEditor, Category = "Debug Utilities")
+	void RefreshTileInspectionView();
+
 	UFUNCTION(BlueprintCallable)
 	bool TraceForGround(FVector TraceStartLocation, FVector& TraceHitLocation, FGridModifierVolumeData& HitVolumeData) const;
 
-	void RetracePathFromIndex(const FIntVector2& IntVector2, TArray<FIntVector2>& Array) const;
 	UFUNCTION()
-	bool FindPath(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath, UPARAM(meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.EGridMovementType")) const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX, TMap<FIntVector2, UTileData*> TileSetData = {}) const;
+	bool FindPath(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath, UPARAM(meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.EGridMovementType")) const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX) const;
+	/** Whether any path links the two tiles, without searching. Lets AI discard cut off targets up front. */
+	UFUNCTION(BlueprintCallable)
+	bool IsTileReachable(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, UPARAM(meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.EGridMovementType")) const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX) const;
 	UFUNCTION()
 	void GetWalkableTilesInRange(const FIntVector2& StartIndex, const int MovementRange, TArray<FIntVector2>& OutRange, UPARAM(meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.EGridMovementType")) const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX );
+	/** FindPath running in a caller owned search context, so AI and previews can query without sharing the actor's scratch state. */
+	bool FindPathWithContext(FGridSearchContext& Context, const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX, const FGridTileFilter& TileFilter = {}) const;
+	/** FindPath that keeps its search in Planner and only repairs what tile changes since the previous query invalidated. */
+	bool FindPathIncremental(FGridPathPlanner& Planner, const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX) const;
+	/**
+	 * FindPath for long routes (AI strategic planning): searches the cluster abstraction for the unit's movement rules,
+	 * then refines it. Near-optimal; routes shorter than a couple of clusters use the exact flat search instead.
+	 */
+	bool FindPathHierarchical(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX) const;
+	/** Single flood fill computing every tile reachable within MovementRange, its cost and the path leading to it. Memoized until the grid changes. */
+	void GetMovementRange(const FIntVector2& StartIndex, const int MovementRange, FGridMovementRange& OutRange, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX) const;
+	void GetMovementRange(FGridSearchContext& Context, const FIntVector2& StartIndex, const int MovementRange, FGridMovementRange& OutRange, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX) const;
 	UFUNCTION()
 	int CalculatePathingCost(TArray<FIntVector2>& Path, bool bUnhinderedByTerrain) const;
 
+	/** Immutable view of the tile data for worker thread readers, republished after any tile change. Game thread only. */
+	FGridSnapshotRef GetTileSnapshot() const;
+	/** FindPath on a task graph worker against the current snapshot. */
+	TFuture<FGridPathResult> RequestPath(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX, const FGridQueryToken& Token = nullptr) const;
+	/** FindPath on a task graph worker, OnComplete runs on the game thread unless the query was cancelled first. */
+	void RequestPath(const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TUniqueFunction<void(FGridPathResult&&)>&& OnComplete, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX, const FGridQueryToken& Token = nullptr);
+	/** GetMovementRange on a task graph worker against the current snapshot. */
+	TFuture<FGridRangeResult> RequestMovementRange(const FIntVector2& StartIndex, const int MovementRange, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX, const FGridQueryToken& Token = nullptr) const;
+	/** GetMovementRange on a task graph worker, OnComplete runs on the game thread unless the query was cancelled first. */
+	void RequestMovementRange(const FIntVector2& StartIndex, const int MovementRange, TUniqueFunction<void(FGridRangeResult&&)>&& OnComplete, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX, const FGridQueryToken& Token = nullptr);
+	/** Scores every move and attack of the team's units against the current snapshot, off the game thread. */
+	TFuture<FGridAIAction> RequestAIAction(TArray<FGridAIUnit> Units, const int32 Team, const FGridAIScoring& Scoring = {}) const;
+
+	/** Battle state behind the characters placed on the grid, their unit handles index OccupantCharacters. */
+	FGridBattleSimulation& GetSimulation() {return Simulation;}
+	const FGridBattleSimulation& GetSimulation() const {return Simulation;}
+	ATacticalBattleCharacter* GetUnitCharacter(const int32 UnitHandle) const {return OccupantCharacters.IsValidIndex(UnitHandle) ? OccupantCharacters[UnitHandle].Get() : nullptr;}
+
+	/**
+	 * Sets the tiles a team's distance field is measured from, typically where its units stand. Only sources that
+	 * differ from the current ones are added or removed; the first call for a team and movement rules builds the field.
+	 */
+	void SetDistanceFieldSources(int32 TeamId, const TArray<FIntVector2>& SourceTiles, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX);
+	/** Incremental update for one unit of the team moving. */
+	void MoveDistanceFieldSource(int32 TeamId, const FIntVector2& FromIndex, const FIntVector2& ToIndex, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX);
+	/** Movement cost for the closest unit of the team to reach the tile, -1 if none can. */
+	UFUNCTION(BlueprintCallable)
+	int SampleDistanceField(int32 TeamId, const FIntVector2& TileIndex, UPARAM(meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.EGridMovementType")) const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX) const;
+	/** Whole distance field indexed by tile id (FGridDistanceField::Unreachable where no unit can go), null if the team has none. */
+	const TArray<int16>* GetDistanceField(int32 TeamId, const uint8 UnitMovementType = static_cast<uint8>(EGridMovementType::Any), const int UnitJumpPower = INT_MAX) const;
+
+	/** Tiles an ability shape centered on Center covers, see EGridShapeType. MaxHeightDelta of 0 or more limits splashes to tiles about as high as the center. */
+	UFUNCTION(BlueprintCallable)
+	void GetTilesInShape(const EGridShapeType Shape, const FIntVector2& Center, const int Radius, TArray<FIntVector2>& OutTiles, const EGridDirection Direction = EGridDirection::PositiveX, const int InnerRadius = 0, const int MaxHeightDelta = -1) const;
+
+	/** Whether the surface of To (raised by TargetHeight) can be seen from an eye EyeHeight above From, over the tile heights. */
+	UFUNCTION(BlueprintCallable)
+	bool HasLineOfSight(const FIntVector2& From, const FIntVector2& To, const int EyeHeight = 1, const int TargetHeight = 0) const;
+	/** Tiles visible from Origin within Radius, cached until the grid changes. */
+	UFUNCTION(BlueprintCallable)
+	void GetVisibleTiles(const FIntVector2& Origin, const int Radius, TArray<FIntVector2>& OutVisibleTiles, const int EyeHeight = 1, const int TargetHeight = 0) const;
+	FGridFieldOfViewRef GetFieldOfView(const FGridSightQuery& Query) const;
+	/** Field of view of every unit at once, the ones not cached yet are computed on the task graph workers. */
+	void GetFieldsOfView(TArrayView<const FGridSightQuery> Queries, TArray<FGridFieldOfViewRef>& OutFieldsOfView) const;
+
+	//Runtime terrain changes (hazards, toggled volumes). Planners pick them up on their next query
+	UFUNCTION(BlueprintCallable, Category="Grid Management")
+	void SetTileMovementCost(const FIntVector2& TileIndex, int NewMovementCost);
+	UFUNCTION(BlueprintCallable, Category="Grid Management")
+	void SetTileAllowedMovement(const FIntVector2& TileIndex, UPARAM(meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.EGridMovementType")) uint8 NewAllowedMovement);
+	UFUNCTION(BlueprintCallable, Category="Grid Management")
+	void SetTileHeight(const FIntVector2& TileIndex, int NewHeight);
+
 private:
-	TMap<FIntVector2, int> GridIndexToInstanceIndex{};
+	FGridTileStore TileStore{};
+	//Units, turns and rules of the battle fought on TileStore, the actor only mirrors it onto characters and tiles
+	FGridBattleSimulation Simulation{TileStore};
+
+	//Spacing between tile centers along X and Y, in actor space
+	float GridStep{0.f};
+	/** Maps a world position onto the tile whose column contains it, O(1). INDEX_NONE if no tile surface is near it. */
+	int32 GetTileIdAtLocation(const FVector& WorldLocation) const;
 
-	UPROPERTY(VisibleInstanceOnly)
-	TMap<FIntVector2, UTileData*> TileDataMap{};
-	int GetTileGValueByIndex(const FIntVector2& TileIndex) const;
+	/** Ground trace results of an environment grid generation, one slot per cell of the grid. */
+	struct FGridGenerationRequest
+	{
+		uint32 RequestId{0};
+		FVector Origin{FVector::ZeroVector};
+		int32 NumPendingTraces{0};
+		int32 NumCells{0};
+		TArray<int32> NumPendingTracesPerChunk{};
+		TArray<FVector> TileLocations{};
+		TArray<int32> TileMovementCosts{};
+		TArray<uint8> TileAllowedMovement{};
+		TBitArray<> SpawnTile{};
+
+		bool IsActive() const {return NumPendingTraces > 0;}
+	};
+	FGridGenerationRequest PendingGeneration{};
+	//Whether the tiles come from ground traces (or a bake of them), only then can a region be traced again
+	bool bIsEnvironmentGrid{false};
+
+	void StartEnvironmentGeneration(const FIntVector2& GridDimension, float InGridStep);
+	void OnGroundTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum, uint32 RequestId);
+	/** Adds every traced tile of a chunk once all of its columns reported back, chunks appear as soon as they are ready. */
+	void FlushGeneratedChunk(int32 ChunkId);
+	/** Resolves the sweep hits of one grid column into the tile location and the modifier volume settings it lies in. */
+	static bool ResolveGroundHits(const TArray<FHitResult>& TraceHits, FVector& TraceHitLocation, FGridModifierVolumeData& HitVolumeData);
+
+	//Character playing each simulation unit, indexed by unit handle like the tile store occupants
+	UPROPERTY()
+	TArray<TObjectPtr<ATacticalBattleCharacter>> OccupantCharacters{};
+
+#if WITH_EDITORONLY_DATA
+	UPROPERTY(VisibleInstanceOnly, Transient, Category = "Debug Utilities")
+	TMap<FIntVector2, TObjectPtr<UTileData>> TileInspectionView{};
+#endif
+
+	//Scratch state for the game thread queries issued by the actor itself
+	mutable FGridSearchContext SearchContext{};
+	mutable TSharedPtr<const FGridSnapshot, ESPMode::ThreadSafe> TileSnapshot{};
+	//Range request of the last selected tile, cancelled only when a new selection replaces it
+	FGridQueryToken SelectionQueryToken{};
+	//Movement ranges recently computed on the game thread, entries of older grid versions are never hit again and age out
+	static constexpr int32 MaxCachedRanges = 64;
+	mutable TLruCache<FGridRangeQueryKey, FGridMovementRange> RangeCache{MaxCachedRanges};
+	FGridRangeQueryKey MakeRangeQueryKey(const FIntVector2& StartIndex, const int MovementRange, const uint8 UnitMovementType, const int UnitJumpPower) const
+	{
+		return {StartIndex, MovementRange, UnitMovementType, UnitJumpPower, TileStore.GetVersion()};
+	}
+	//Per movement rules data built on demand, keyed by GetMovementRulesKey
+	mutable TMap<uint64, FGridPathHierarchy> PathHierarchies{};
+	mutable TMap<uint64, FGridComponentLabels> ComponentLabels{};
+	//Keyed by GetMovementRulesKey with the team id in the high bits
+	mutable TMap<uint64, FGridDistanceField> DistanceFields{};
+	mutable FGridVisibilityCache VisibilityCache{};
+	static uint64 GetDistanceFieldKey(const int32 TeamId, const uint8 UnitMovementType, const int UnitJumpPower) {return static_cast<uint64>(static_cast<uint32>(TeamId)) << 40 ^ GetMovementRulesKey(UnitMovementType, UnitJumpPower);}
+	//Jump power takes bits 8-39 as is: a negative one cannot step at all, unlike 0 which still walks flat ground
+	static uint64 GetMovementRulesKey(const uint8 UnitMovementType, const int UnitJumpPower) {return static_cast<uint64>(static_cast<uint32>(UnitJumpPower)) << 8 | UnitMovementType;}
+	FGridComponentLabels& GetComponentLabels(uint8 UnitMovementType, int UnitJumpPower) const;
 	int GetTileMovementCost(const FIntVector2& TileIndex, bool bUnhinderedByTerrain) const;
-	FIntVector2 GetLowestFValueTileIndex(const TArray<FIntVector2>& GroupToSearch) const;
 	
 
+	class UHierarchicalInstancedStaticMeshComponent* GetOrCreateChunkComponent(int32 ChunkId);
+	class UHierarchicalInstancedStaticMeshComponent* GetTileChunkComponent(int32 TileId) const;
+	/** Adds the instances of a batch of tiles that all belong to the same chunk with a single call. Without Heights tiles get the default height. */
+	void AddTilesToChunk(int32 ChunkId, const TArray<int32>& TileIds, const TArray<FTransform>& TileTransforms, const TArray<int32>& MovementCosts, const TArray<uint8>& AllowedMovement, const TArray<int32>& Heights = {});
+
 	void AddTileAt(const FTransform& TileTransform, const FIntVector2& GridIndex, const FGridModifierVolumeData InTileSettings);
 	bool RemoveTileAt(const FIntVector2& GridIndexToRemove);
 	
+	/** Highlight values requested since the last flush. Only tiles whose value changed are queued. */
+	struct FGridHighlightBatch
+	{
+		TBitArray<> Requested{};
+		//Value last written to the tile's instance custom data
+		TBitArray<> Rendered{};
+		TBitArray<> Queued{};
+		TArray<int32> QueuedTiles{};
+
+		void Init(const int32 NumCells)
+		{
+			Requested.Init(false, NumCells);
+			Rendered.Init(false, NumCells);
+			Queued.Init(false, NumCells);
+			QueuedTiles.Reset();
+		}
+
+		void Set(const int32 TileId, const bool bHighlighted)
+		{
+			if(Requested[TileId] == bHighlighted)
+			{
+				return;
+			}
+			Requested[TileId] = bHighlighted;
+			if(!Queued[TileId])
+			{
+				Queued[TileId] = true;
+				QueuedTiles.Add(TileId);
+			}
+		}
+
+		//Removed tiles take their instance with them, a tile added later starts unlit
+		void Forget(const int32 TileId)
+		{
+			Requested[TileId] = false;
+			Rendered[TileId] = false;
+		}
+	};
+	FGridHighlightBatch TileHighlights{};
+
 	void HighlightTile(const FIntVector2& GridIndex);
 	void UnlightTile(const FIntVector2& GridIndex);
 	void UnlightAllTiles();
+	/** Writes the queued highlight changes to the chunk components, marking each touched chunk dirty once. */
+	void FlushTileHighlights();
 
 	UFUNCTION()
 	void ApplyStateToTile(const FIntVector2& TileIndex, UPARAM(meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.ETileState")) const uint8 StateToAdd);
@@ -231,13 +448,12 @@ private:
 	FIntVector2 HoveredTileIndex{-1,-1};
 
 	static int GetDistanceBetweenTiles(const FIntVector2& TileAIndex,const FIntVector2& TileBIndex);
-	void GetAllTilesInRange(const FIntVector2& StartIndex, const int MovementRange, TArray<FIntVector2>& OutRange,TMap<FIntVector2, UTileData*> TileSetData = {}) const;
+	void GetAllTilesInRange(const FIntVector2& StartIndex, const int MovementRange, TArray<FIntVector2>& OutRange, const FGridTileFilter& TileFilter = {}) const;
 	UFUNCTION()
 	void SelectHoveredTile();
 
-	void GetTileNeighborhood(const FIntVector2& TileIndex, TArray<FIntVector2>& OutNeighborhood, TMap<FIntVector2, UTileData*> TileSetData = {}) const;
-	UFUNCTION()
-	void GetWalkableNeighbors(const FIntVector2& TileIndex, TArray<FIntVector2>& OutNeighborhood, UPARAM(meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.EGridMovementType")) const uint8 MoveTypeToCheck = static_cast<uint8>(EGridMovementType::Any), int JumpPower = INT_MAX, TMap<FIntVector2, UTileData*> TileSetData = {}) const;
+	void GetTileNeighborhood(const FIntVector2& TileIndex, TArray<FIntVector2>& OutNeighborhood, const FGridTileFilter& TileFilter = {}) const;
+	void GetWalkableNeighbors(const FIntVector2& TileIndex, TArray<FIntVector2>& OutNeighborhood, const uint8 MoveTypeToCheck = static_cast<uint8>(EGridMovementType::Any), int JumpPower = INT_MAX, const FGridTileFilter& TileFilter = {}) const;
 
 	bool IsTileSelected(const FIntVector2& TileIndex);
 
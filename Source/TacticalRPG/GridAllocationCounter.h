@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+#include <atomic>
+
+/**
+ * Forwards everything to the engine allocator, counting the game thread allocations made while enabled. Installed as
+ * GMalloc on first use and kept for the rest of the process: blocks stay owned by the inner allocator, and other threads
+ * may still be calling through it, so it is never swapped back out or freed.
+ */
+class FGridAllocationCounter final : public FMalloc
+{
+public:
+	static FGridAllocationCounter& Get()
+	{
+		check(IsInGameThread());
+		static FGridAllocationCounter* Instance = nullptr;
+		if(Instance == nullptr)
+		{
+			Instance = new FGridAllocationCounter(GMalloc);
+			GMalloc = Instance;
+		}
+		return *Instance;
+	}
+
+	virtual void* Malloc(const SIZE_T Count, const uint32 Alignment) override {CountAllocation(); return InnerMalloc->Malloc(Count, Alignment);}
+	virtual void* TryMalloc(const SIZE_T Count, const uint32 Alignment) override {CountAllocation(); return InnerMalloc->TryMalloc(Count, Alignment);}
+	virtual void* Realloc(void* Original, const SIZE_T Count, const uint32 Alignment) override
+	{
+		if(Count != 0)
+		{
+			CountAllocation();
+		}
+		return InnerMalloc->Realloc(Original, Count, Alignment);
+	}
+	virtual void* TryRealloc(void* Original, const SIZE_T Count, const uint32 Alignment) override
+	{
+		if(Count != 0)
+		{
+			CountAllocation();
+		}
+		return InnerMalloc->TryRealloc(Original, Count, Alignment);
+	}
+	virtual void Free(void* Original) override {InnerMalloc->Free(Original);}
+	virtual SIZE_T QuantizeSize(const SIZE_T Count, const uint32 Alignment) override {return InnerMalloc->QuantizeSize(Count, Alignment);}
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override {return InnerMalloc->GetAllocationSize(Original, SizeOut);}
+	virtual void Trim(const bool bTrimThreadCaches) override {InnerMalloc->Trim(bTrimThreadCaches);}
+	virtual void SetupTLSCachesOnCurrentThread() override {InnerMalloc->SetupTLSCachesOnCurrentThread();}
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override {InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread();}
+	virtual bool IsInternallyThreadSafe() const override {return InnerMalloc->IsInternallyThreadSafe();}
+	virtual bool ValidateHeap() override {return InnerMalloc->ValidateHeap();}
+	virtual void UpdateStats() override {InnerMalloc->UpdateStats();}
+	virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override {InnerMalloc->GetAllocatorStats(OutStats);}
+	virtual void DumpAllocatorStats(FOutputDevice& Ar) override {InnerMalloc->DumpAllocatorStats(Ar);}
+	virtual const TCHAR* GetDescriptiveName() override {return InnerMalloc->GetDescriptiveName();}
+
+	void SetCounting(const bool bInCounting) {bCounting = bInCounting;}
+	uint64 GetNumAllocations() const {return NumAllocations;}
+
+private:
+	explicit FGridAllocationCounter(FMalloc* InInnerMalloc) : InnerMalloc(InInnerMalloc) {}
+
+	void CountAllocation()
+	{
+		if(bCounting && IsInGameThread())
+		{
+			++NumAllocations;
+		}
+	}
+
+	FMalloc* InnerMalloc{nullptr};
+	std::atomic<bool> bCounting{false};
+	//Only the game thread writes it
+	uint64 NumAllocations{0};
+};
+
+/** Game thread allocations made while in scope. Scopes do not nest. */
+class FGridAllocationScope
+{
+public:
+	FGridAllocationScope() : Counter(FGridAllocationCounter::Get()), NumAllocationsBefore(Counter.GetNumAllocations()) {Counter.SetCounting(true);}
+	~FGridAllocationScope() {Counter.SetCounting(false);}
+
+	uint64 GetNumAllocations() const {return Counter.GetNumAllocations() - NumAllocationsBefore;}
+
+private:
+	FGridAllocationCounter& Counter;
+	uint64 NumAllocationsBefore{0};
+};
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridAsyncQuery.h"
+
+FGridSearchContext& GridAsyncQuery::GetWorkerSearchContext()
+{
+	static thread_local FGridSearchContext WorkerSearchContext;
+	return WorkerSearchContext;
+}
+
+FGridPathResult GridAsyncQuery::RunPathQuery(const FGridSnapshot& Tiles, const FIntVector2& StartIndex, const FIntVector2& TargetIndex,
+	const uint8 MovementType, const int32 JumpPower, const FGridQueryToken& Token)
+{
+	FGridPathResult Result;
+	if(IsCancelled(Token))
+	{
+		Result.bCancelled = true;
+		return Result;
+	}
+	const TGridMovementGraph<FGridSnapshot> Graph{Tiles, MovementType, JumpPower};
+	if(Graph.IsSearchable(StartIndex) && Graph.IsSearchable(TargetIndex))
+	{
+		Result.bFound = GridPathfinding::FindPath(Graph, GetWorkerSearchContext(), Graph.ToTileId(StartIndex), Graph.ToTileId(TargetIndex), Result.Path);
+	}
+	Result.bCancelled = IsCancelled(Token);
+	return Result;
+}
+
+FGridRangeResult GridAsyncQuery::RunRangeQuery(const FGridSnapshot& Tiles, const FIntVector2& StartIndex, const int32 MovementRange,
+	const uint8 MovementType, const int32 JumpPower, const FGridQueryToken& Token)
+{
+	FGridRangeResult Result;
+	if(IsCancelled(Token))
+	{
+		Result.bCancelled = true;
+		return Result;
+	}
+	const TGridMovementGraph<FGridSnapshot> Graph{Tiles, MovementType, JumpPower};
+	if(Graph.IsSearchable(StartIndex))
+	{
+		GridPathfinding::FindReachableTiles(Graph, GetWorkerSearchContext(), Graph.ToTileId(StartIndex), MovementRange, Result.Range);
+	}
+	Result.bCancelled = IsCancelled(Token);
+	return Result;
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPathfinding.h"
+#include "GridSnapshot.h"
+#include <atomic>
+
+/** Flag shared between a game thread owner and its in-flight queries. Cancelled queries skip their search and never report back. */
+class TACTICALRPG_API FGridQueryCancellation
+{
+public:
+	void Cancel() {bCancelled.store(true, std::memory_order_relaxed);}
+	bool IsCancelled() const {return bCancelled.load(std::memory_order_relaxed);}
+
+private:
+	std::atomic<bool> bCancelled{false};
+};
+using FGridQueryToken = TSharedPtr<FGridQueryCancellation, ESPMode::ThreadSafe>;
+
+struct TACTICALRPG_API FGridPathResult
+{
+	bool bFound{false};
+	bool bCancelled{false};
+	TArray<FIntVector2> Path{};
+};
+
+struct TACTICALRPG_API FGridRangeResult
+{
+	bool bCancelled{false};
+	FGridMovementRange Range{};
+};
+
+/**
+ * Searches run on task graph workers against an immutable tile snapshot. Each worker thread keeps its own search
+ * context, so queries never share scratch state and never allocate once the worker has warmed up.
+ */
+namespace GridAsyncQuery
+{
+	TACTICALRPG_API FGridPathResult RunPathQuery(const FGridSnapshot& Tiles, const FIntVector2& StartIndex, const FIntVector2& TargetIndex, uint8 MovementType, int32 JumpPower, const FGridQueryToken& Token);
+	TACTICALRPG_API FGridRangeResult RunRangeQuery(const FGridSnapshot& Tiles, const FIntVector2& StartIndex, int32 MovementRange, uint8 MovementType, int32 JumpPower, const FGridQueryToken& Token);
+
+	/** Search scratch owned by the calling thread, for work running on pool threads. Never share the reference across threads. */
+	TACTICALRPG_API FGridSearchContext& GetWorkerSearchContext();
+
+	inline bool IsCancelled(const FGridQueryToken& Token) {return Token.IsValid() && Token->IsCancelled();}
+}
@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridBakedGrid.h"
+
+#include "Misc/FileHelper.h"
+
+namespace
+{
+	template<typename ElementType>
+	void WriteArray(TArray<uint8>& Bytes, const TArray<ElementType>& Array)
+	{
+		Bytes.Append(reinterpret_cast<const uint8*>(Array.GetData()), Array.Num() * sizeof(ElementType));
+	}
+
+	template<typename ElementType>
+	bool ReadArray(const TArray<uint8>& Bytes, int64& Offset, const int32 Num, TArray<ElementType>& OutArray)
+	{
+		const int64 Size = static_cast<int64>(Num) * sizeof(ElementType);
+		if(Num < 0 || Offset + Size > Bytes.Num())
+		{
+			return false;
+		}
+		OutArray.SetNumUninitialized(Num);
+		FMemory::Memcpy(OutArray.GetData(), Bytes.GetData() + Offset, Size);
+		Offset += Size;
+		return true;
+	}
+}
+
+void FGridBakedGrid::Capture(const FGridTileStore& Tiles, const float InGridStep, const TFunctionRef<FVector(int32)> GetTileLocation)
+{
+	Reset();
+	Dimension = Tiles.GetDimension();
+	GridStep = InGridStep;
+	const int32 NumTiles = Tiles.GetNumTiles();
+	TileIds.Reserve(NumTiles);
+	MovementCosts.Reserve(NumTiles);
+	Heights.Reserve(NumTiles);
+	AllowedMovement.Reserve(NumTiles);
+	Locations.Reserve(NumTiles);
+	ChunkTileOffsets.Reserve(Tiles.GetNumChunks() + 1);
+	for(int32 ChunkId = 0; ChunkId < Tiles.GetNumChunks(); ChunkId++)
+	{
+		ChunkTileOffsets.Add(TileIds.Num());
+		Tiles.ForEachCellInChunk(ChunkId, [&](const int32 TileId)
+		{
+			if(!Tiles.HasTile(TileId))
+			{
+				return;
+			}
+			TileIds.Add(TileId);
+			MovementCosts.Add(Tiles.GetMovementCost(TileId));
+			Heights.Add(Tiles.GetHeight(TileId));
+			AllowedMovement.Add(Tiles.GetAllowedMovementTypes(TileId));
+			Locations.Add(FVector3f(GetTileLocation(TileId)));
+		});
+	}
+	ChunkTileOffsets.Add(TileIds.Num());
+}
+
+bool FGridBakedGrid::SaveToFile(const FString& Filename) const
+{
+	const FHeader Header{FileMagic, FormatVersion, Dimension.X, Dimension.Y, GridStep, ChunkTileOffsets.Num() - 1, GetNumTiles()};
+	TArray<uint8> Bytes;
+	Bytes.Reserve(sizeof(FHeader) + ChunkTileOffsets.Num() * sizeof(int32) + GetNumTiles() * (3 * sizeof(int32) + sizeof(uint8) + sizeof(FVector3f)));
+	Bytes.Append(reinterpret_cast<const uint8*>(&Header), sizeof(FHeader));
+	WriteArray(Bytes, ChunkTileOffsets);
+	WriteArray(Bytes, TileIds);
+	WriteArray(Bytes, MovementCosts);
+	WriteArray(Bytes, Heights);
+	WriteArray(Bytes, Locations);
+	//Last so the wider arrays above stay aligned
+	WriteArray(Bytes, AllowedMovement);
+	return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+bool FGridBakedGrid::LoadFromFile(const FString& Filename)
+{
+	Reset();
+	TArray<uint8> Bytes;
+	if(!FFileHelper::LoadFileToArray(Bytes, *Filename, FILEREAD_Silent) || Bytes.Num() < sizeof(FHeader))
+	{
+		return false;
+	}
+	FHeader Header;
+	FMemory::Memcpy(&Header, Bytes.GetData(), sizeof(FHeader));
+	if(Header.Magic != FileMagic || Header.Version != FormatVersion || Header.DimensionX < 0 || Header.DimensionY < 0
+		|| static_cast<int64>(Header.DimensionX) * Header.DimensionY > MAX_int32)
+	{
+		return false;
+	}
+	Dimension = {Header.DimensionX, Header.DimensionY};
+	GridStep = Header.GridStep;
+	int64 Offset = sizeof(FHeader);
+	const bool bRead = ReadArray(Bytes, Offset, Header.NumChunks + 1, ChunkTileOffsets)
+		&& ReadArray(Bytes, Offset, Header.NumTiles, TileIds)
+		&& ReadArray(Bytes, Offset, Header.NumTiles, MovementCosts)
+		&& ReadArray(Bytes, Offset, Header.NumTiles, Heights)
+		&& ReadArray(Bytes, Offset, Header.NumTiles, Locations)
+		&& ReadArray(Bytes, Offset, Header.NumTiles, AllowedMovement);
+	if(!bRead || Offset != Bytes.Num() || !IsValid())
+	{
+		Reset();
+		return false;
+	}
+	return true;
+}
+
+bool FGridBakedGrid::IsValid() const
+{
+	constexpr int32 ChunkSize = FGridTileStore::ChunkSize;
+	const int32 ChunksX = FMath::DivideAndRoundUp(Dimension.X, ChunkSize);
+	const int32 NumChunks = ChunksX * FMath::DivideAndRoundUp(Dimension.Y, ChunkSize);
+	if(ChunkTileOffsets.Num() != NumChunks + 1 || ChunkTileOffsets[0] != 0 || ChunkTileOffsets.Last() != GetNumTiles())
+	{
+		return false;
+	}
+	for(int32 ChunkId = 0; ChunkId < NumChunks; ChunkId++)
+	{
+		if(ChunkTileOffsets[ChunkId] > ChunkTileOffsets[ChunkId + 1])
+		{
+			return false;
+		}
+		for(int32 i = ChunkTileOffsets[ChunkId]; i < ChunkTileOffsets[ChunkId + 1]; i++)
+		{
+			const int32 TileId = TileIds[i];
+			if(TileId < 0 || TileId >= Dimension.X * Dimension.Y || ((TileId / Dimension.X) / ChunkSize) * ChunksX + (TileId % Dimension.X) / ChunkSize != ChunkId)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void FGridBakedGrid::Reset()
+{
+	Dimension = {0,0};
+	GridStep = 0.f;
+	ChunkTileOffsets.Reset();
+	TileIds.Reset();
+	MovementCosts.Reset();
+	Heights.Reset();
+	AllowedMovement.Reset();
+	Locations.Reset();
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridTileStore.h"
+
+/**
+ * Generated grid flattened to a versioned binary file: a fixed header followed by one array per tile field, every
+ * array sorted by chunk so each chunk's tiles are contiguous. Loading is one file read and a copy per array, no
+ * traces. Little endian only, files are baked and loaded on the same platforms.
+ */
+struct TACTICALRPG_API FGridBakedGrid
+{
+	static constexpr uint32 FileMagic = 0x44524754; //"TGRD"
+	//Bump whenever the layout changes, older files are then rejected and the grid is traced again
+	static constexpr uint32 FormatVersion = 1;
+
+	FIntVector2 Dimension{0,0};
+	float GridStep{0.f};
+	//NumChunks + 1 entries, tiles of chunk C are [ChunkTileOffsets[C], ChunkTileOffsets[C + 1])
+	TArray<int32> ChunkTileOffsets{};
+	TArray<int32> TileIds{};
+	TArray<int32> MovementCosts{};
+	TArray<int32> Heights{};
+	TArray<uint8> AllowedMovement{};
+	//Instance location of each tile, relative to the grid actor
+	TArray<FVector3f> Locations{};
+
+	int32 GetNumTiles() const {return TileIds.Num();}
+
+	/** Copies every tile of the store, GetTileLocation returns the actor relative instance location of a tile id. */
+	void Capture(const FGridTileStore& Tiles, float InGridStep, TFunctionRef<FVector(int32)> GetTileLocation);
+
+	bool SaveToFile(const FString& Filename) const;
+	/** False if the file is missing, of another format version or malformed; the grid is left empty then. */
+	bool LoadFromFile(const FString& Filename);
+
+private:
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		int32 DimensionX;
+		int32 DimensionY;
+		float GridStep;
+		int32 NumChunks;
+		int32 NumTiles;
+	};
+
+	bool IsValid() const;
+	void Reset();
+};
@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridBattleSimulation.h"
+
+#include "GridStats.h"
+
+void FGridBattleSimulation::Reset()
+{
+	for(const FGridAIUnit& Unit : Units)
+	{
+		if(Unit.Health > 0 && Tiles.HasTile(Unit.Location) && Tiles.GetOccupant(Tiles.ToTileId(Unit.Location)) == Unit.Handle)
+		{
+			Tiles.SetOccupant(Tiles.ToTileId(Unit.Location), INDEX_NONE);
+		}
+	}
+	Units.Reset();
+	ActiveTeam = INDEX_NONE;
+	Round = 0;
+	Snapshot.Reset();
+}
+
+int32 FGridBattleSimulation::AddUnit(const FGridAIUnit& Unit)
+{
+	if(Unit.Health <= 0 || !CanStandOn(Unit.Location, INDEX_NONE))
+	{
+		return INDEX_NONE;
+	}
+	FGridAIUnit& AddedUnit = Units.Add_GetRef(Unit);
+	AddedUnit.Handle = Units.Num() - 1;
+	Tiles.SetOccupant(Tiles.ToTileId(AddedUnit.Location), AddedUnit.Handle);
+	if(ActiveTeam == INDEX_NONE || (AddedUnit.Team < ActiveTeam && Round == 0))
+	{
+		//Until the battle starts the lowest team goes first
+		ActiveTeam = AddedUnit.Team;
+	}
+	return AddedUnit.Handle;
+}
+
+bool FGridBattleSimulation::PlaceUnit(const int32 Handle, const FIntVector2& Location)
+{
+	if(!IsUnitAlive(Handle) || !CanStandOn(Location, Handle))
+	{
+		return false;
+	}
+	FGridAIUnit& Unit = Units[Handle];
+	//Re-placing a unit where it stands leaves the store, and everything keyed on its versions, untouched
+	if(Unit.Location == Location && Tiles.GetOccupant(Tiles.ToTileId(Location)) == Handle)
+	{
+		return true;
+	}
+	if(Tiles.HasTile(Unit.Location) && Tiles.GetOccupant(Tiles.ToTileId(Unit.Location)) == Handle)
+	{
+		Tiles.SetOccupant(Tiles.ToTileId(Unit.Location), INDEX_NONE);
+	}
+	Unit.Location = Location;
+	Tiles.SetOccupant(Tiles.ToTileId(Location), Handle);
+	return true;
+}
+
+bool FGridBattleSimulation::MoveUnit(const int32 Handle, const FIntVector2& Destination)
+{
+	if(!IsUnitAlive(Handle) || !CanStandOn(Destination, Handle))
+	{
+		return false;
+	}
+	const FGridAIUnit& Unit = Units[Handle];
+	const FGridMovementGraph Graph{Tiles, Unit.MovementType, Unit.JumpPower};
+	if(!Graph.IsSearchable(Unit.Location))
+	{
+		return false;
+	}
+	GridPathfinding::FindReachableTiles(Graph, SearchContext, Graph.ToTileId(Unit.Location), Unit.MovementRange, MovementRange);
+	return MovementRange.Contains(Destination) && PlaceUnit(Handle, Destination);
+}
+
+bool FGridBattleSimulation::Attack(const int32 AttackerHandle, const int32 TargetHandle)
+{
+	if(!IsUnitAlive(AttackerHandle) || !IsUnitAlive(TargetHandle))
+	{
+		return false;
+	}
+	const FGridAIUnit& Attacker = Units[AttackerHandle];
+	FGridAIUnit& Target = Units[TargetHandle];
+	const int32 Distance = FMath::Abs(Attacker.Location.X - Target.Location.X) + FMath::Abs(Attacker.Location.Y - Target.Location.Y);
+	if(Attacker.Team == Target.Team || Distance > Attacker.AttackRange)
+	{
+		return false;
+	}
+	Target.Health = FMath::Max(Target.Health - Attacker.AttackPower, 0);
+	if(Target.Health == 0)
+	{
+		Tiles.SetOccupant(Tiles.ToTileId(Target.Location), INDEX_NONE);
+	}
+	return true;
+}
+
+bool FGridBattleSimulation::ApplyAction(const FGridAIAction& Action)
+{
+	if(!IsUnitAlive(Action.UnitHandle))
+	{
+		return false;
+	}
+	if(Action.MoveTo != Units[Action.UnitHandle].Location && !MoveUnit(Action.UnitHandle, Action.MoveTo))
+	{
+		return false;
+	}
+	return Action.TargetHandle == INDEX_NONE || Attack(Action.UnitHandle, Action.TargetHandle);
+}
+
+void FGridBattleSimulation::EndTurn()
+{
+	const int32 NextTeam = FindNextTeam(ActiveTeam);
+	if(NextTeam == INDEX_NONE || NextTeam <= ActiveTeam)
+	{
+		++Round;
+	}
+	ActiveTeam = NextTeam;
+}
+
+void FGridBattleSimulation::PlayTurn(const FGridAIScoring& Scoring)
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridBattleTurn);
+	for(int32 Handle = 0; Handle < Units.Num(); Handle++)
+	{
+		if(Units[Handle].Team != ActiveTeam || !IsUnitAlive(Handle))
+		{
+			continue;
+		}
+		Snapshot = FGridSnapshot::Create(Tiles, Snapshot.Get());
+		const FGridAIAction Action = FGridTacticalAI::FindBestActionForUnit(*Snapshot, Units, Handle, Scoring);
+		if(Action.IsValid())
+		{
+			ApplyAction(Action);
+		}
+	}
+	EndTurn();
+}
+
+int32 FGridBattleSimulation::RunBattle(const int32 MaxRounds, const FGridAIScoring& Scoring)
+{
+	if(ActiveTeam == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+	while(Round < MaxRounds && GetWinningTeam() == INDEX_NONE)
+	{
+		PlayTurn(Scoring);
+	}
+	return GetWinningTeam();
+}
+
+int32 FGridBattleSimulation::GetWinningTeam() const
+{
+	int32 WinningTeam = INDEX_NONE;
+	for(const FGridAIUnit& Unit : Units)
+	{
+		if(Unit.Health <= 0)
+		{
+			continue;
+		}
+		if(WinningTeam != INDEX_NONE && Unit.Team != WinningTeam)
+		{
+			return INDEX_NONE;
+		}
+		WinningTeam = Unit.Team;
+	}
+	return WinningTeam;
+}
+
+bool FGridBattleSimulation::CanStandOn(const FIntVector2& Location, const int32 Handle) const
+{
+	if(!Tiles.HasTile(Location))
+	{
+		return false;
+	}
+	const int32 Occupant = Tiles.GetOccupant(Tiles.ToTileId(Location));
+	return Occupant == INDEX_NONE || Occupant == Handle;
+}
+
+int32 FGridBattleSimulation::FindNextTeam(const int32 Team) const
+{
+	int32 NextTeam = INDEX_NONE;
+	int32 FirstTeam = INDEX_NONE;
+	for(const FGridAIUnit& Unit : Units)
+	{
+		if(Unit.Health <= 0)
+		{
+			continue;
+		}
+		if(FirstTeam == INDEX_NONE || Unit.Team < FirstTeam)
+		{
+			FirstTeam = Unit.Team;
+		}
+		if(Unit.Team > Team && (NextTeam == INDEX_NONE || Unit.Team < NextTeam))
+		{
+			NextTeam = Unit.Team;
+		}
+	}
+	return NextTeam != INDEX_NONE ? NextTeam : FirstTeam;
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPathfinding.h"
+#include "GridSnapshot.h"
+#include "GridTacticalAI.h"
+#include "GridTileStore.h"
+
+/**
+ * Turn based battle state and rules over a tile store, with no UObject, world or rendering involved: units, their
+ * occupancy of the grid, movement under their movement type and jump power, attacks and the team turn order.
+ * Everything is applied in a fixed order and the AI reduction is order independent, so a battle replays identically
+ * from the same grid and units. AGridActor drives one for the level; headless runs build a store and one of these.
+ */
+class TACTICALRPG_API FGridBattleSimulation
+{
+public:
+	explicit FGridBattleSimulation(FGridTileStore& InTiles) : Tiles(InTiles) {}
+
+	/** Removes every unit from the battle and the grid, and restarts the turn order. */
+	void Reset();
+
+	/** Adds a unit standing on its Location, returns its handle or INDEX_NONE if that tile is missing or taken. */
+	int32 AddUnit(const FGridAIUnit& Unit);
+	/** Puts a unit on a free tile regardless of movement rules, for setup and scripted moves. */
+	bool PlaceUnit(int32 Handle, const FIntVector2& Location);
+
+	/**
+	 * Moves a unit to a free tile it can reach within its movement range. Units may pass through other units' tiles,
+	 * matching the ranges the AI scores, but never stop on one.
+	 */
+	bool MoveUnit(int32 Handle, const FIntVector2& Destination);
+	/** Attacker deals its attack power to an enemy within its attack range (Manhattan distance), a unit at 0 health leaves the grid. */
+	bool Attack(int32 AttackerHandle, int32 TargetHandle);
+	/** Move then attack or wait, as decided by FGridTacticalAI. */
+	bool ApplyAction(const FGridAIAction& Action);
+
+	/** Hands the turn to the next team with living units, a new round starts once every team played. */
+	void EndTurn();
+	/** Lets the AI play every living unit of the active team, in handle order, then ends the turn. */
+	void PlayTurn(const FGridAIScoring& Scoring = {});
+	/** Plays AI turns until one team is left or MaxRounds rounds passed. Returns the winning team, INDEX_NONE on a draw. */
+	int32 RunBattle(int32 MaxRounds, const FGridAIScoring& Scoring = {});
+
+	/** Only team with living units, INDEX_NONE while several (or none) have some. */
+	int32 GetWinningTeam() const;
+	int32 GetActiveTeam() const {return ActiveTeam;}
+	int32 GetRound() const {return Round;}
+
+	const TArray<FGridAIUnit>& GetUnits() const {return Units;}
+	const FGridAIUnit* GetUnit(const int32 Handle) const {return Units.IsValidIndex(Handle) ? &Units[Handle] : nullptr;}
+	bool IsUnitAlive(const int32 Handle) const {return Units.IsValidIndex(Handle) && Units[Handle].Health > 0;}
+	const FGridTileStore& GetTiles() const {return Tiles;}
+
+private:
+	bool CanStandOn(const FIntVector2& Location, int32 Handle) const;
+	/** Lowest team id above Team with a living unit, wrapping around to the lowest one. */
+	int32 FindNextTeam(int32 Team) const;
+
+	FGridTileStore& Tiles;
+	TArray<FGridAIUnit> Units{};
+	int32 ActiveTeam{INDEX_NONE};
+	int32 Round{0};
+
+	FGridSearchContext SearchContext{};
+	FGridMovementRange MovementRange{};
+	//Last snapshot the AI read, the next one only copies the chunks units moved in since
+	TSharedPtr<const FGridSnapshot, ESPMode::ThreadSafe> Snapshot{};
+};
@@ -0,0 +1,441 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridBenchmarkCommandlet.h"
+
+#include "Algo/Reverse.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GridAllocationCounter.h"
+#include "GridActor.h"
+#include "GridData.h"
+#include "GridModifierVolume.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	//Engine basic shapes are 100 units wide, the tile plane sets the grid step
+	constexpr float BasicShapeSize = 100.f;
+	//Grid origin above the ground, within the ground trace depth of the actor
+	constexpr float GridSpawnHeight = 500.f;
+	//Safety net for a generation that never completes, at one tick per frame
+	constexpr int32 MaxGenerationTicks = 600;
+
+	/** Per-tile search state of the baseline, what UTileData held before the tile store. */
+	struct FBaselinePathNode
+	{
+		FIntVector2 Connection{-1, -1};
+		int32 G{MAX_int32};
+		int32 H{0};
+	};
+
+	/**
+	 * The list-based A* FindPath shipped before the binary heap search, kept only as the benchmark baseline: per-tile state
+	 * in a map reset on every query, open and closed lists searched linearly. Walks the same graph with the same costs.
+	 */
+	bool FindPathListBaseline(const FGridMovementGraph& Graph, TMap<FIntVector2, FBaselinePathNode>& Nodes, const FIntVector2& StartIndex, const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath)
+	{
+		OutPath.Empty();
+		if(!Graph.IsSearchable(StartIndex) || !Graph.IsSearchable(TargetIndex))
+		{
+			return false;
+		}
+		for(auto& [Index, Node] : Nodes)
+		{
+			Node = {};
+		}
+		const int32 TargetId = Graph.ToTileId(TargetIndex);
+		FBaselinePathNode& StartNode = Nodes.FindChecked(StartIndex);
+		StartNode.G = 0;
+		StartNode.H = Graph.GetHeuristic(Graph.ToTileId(StartIndex), TargetId);
+		TArray<FIntVector2> OpenList{};
+		OpenList.AddUnique(StartIndex);
+		TArray<FIntVector2> ClosedList{};
+
+		while(!OpenList.IsEmpty())
+		{
+			FIntVector2 CurrentIndex = OpenList[0];
+			for(const FIntVector2& Index : OpenList)
+			{
+				const FBaselinePathNode& Node = Nodes.FindChecked(Index);
+				const FBaselinePathNode& Best = Nodes.FindChecked(CurrentIndex);
+				if(Node.G + Node.H < Best.G + Best.H || (Node.G + Node.H == Best.G + Best.H && Node.H < Best.H))
+				{
+					CurrentIndex = Index;
+				}
+			}
+			if(CurrentIndex == TargetIndex)
+			{
+				for(FIntVector2 Index = TargetIndex; Index != StartIndex; Index = Nodes.FindChecked(Index).Connection)
+				{
+					OutPath.Add(Index);
+				}
+				OutPath.Add(StartIndex);
+				Algo::Reverse(OutPath);
+				return true;
+			}
+			OpenList.Remove(CurrentIndex);
+			ClosedList.AddUnique(CurrentIndex);
+			const int32 CurrentG = Nodes.FindChecked(CurrentIndex).G;
+			TArray<int32> Neighbors;
+			Graph.ForEachNeighbor(Graph.ToTileId(CurrentIndex), [&Neighbors](const int32 NeighborId) {Neighbors.Add(NeighborId);});
+			for(const int32 NeighborId : Neighbors)
+			{
+				const FIntVector2 Index = Graph.ToGridIndex(NeighborId);
+				if(ClosedList.Contains(Index))
+				{
+					continue;
+				}
+				const int32 TentativeGValue = CurrentG + Graph.GetEnterCost(NeighborId);
+				FBaselinePathNode& Node = Nodes.FindChecked(Index);
+				if(TentativeGValue < Node.G)
+				{
+					Node.Connection = CurrentIndex;
+					Node.G = TentativeGValue;
+					Node.H = Graph.GetHeuristic(NeighborId, TargetId);
+					OpenList.AddUnique(Index);
+				}
+			}
+		}
+		return false;
+	}
+
+	/** Latency samples and allocations of one workload, Op is called once per sample with the sample index. */
+	template<typename OpType>
+	TSharedRef<FJsonObject> RunWorkload(const TCHAR* Name, const int32 NumSamples, const int32 NumWarmupSamples, OpType&& Op)
+	{
+		for(int32 Sample = 0; Sample < NumWarmupSamples; Sample++)
+		{
+			Op(Sample);
+		}
+		TArray<double> Latencies{};
+		Latencies.Reserve(NumSamples);
+		double TotalSeconds = 0.;
+		uint64 NumAllocations = 0;
+		{
+			const FGridAllocationScope AllocationScope{};
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			for(int32 Sample = 0; Sample < NumSamples; Sample++)
+			{
+				const uint64 SampleStartCycles = FPlatformTime::Cycles64();
+				Op(NumWarmupSamples + Sample);
+				Latencies.Add(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - SampleStartCycles) * 1e6);
+			}
+			TotalSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+			NumAllocations = AllocationScope.GetNumAllocations();
+		}
+
+		Latencies.Sort();
+		const auto Percentile = [&Latencies](const double Fraction)
+		{
+			return Latencies.IsEmpty() ? 0. : Latencies[FMath::Clamp(FMath::CeilToInt(Fraction * Latencies.Num()) - 1, 0, Latencies.Num() - 1)];
+		};
+		double TotalLatency = 0.;
+		for(const double Latency : Latencies)
+		{
+			TotalLatency += Latency;
+		}
+
+		TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+		Result->SetStringField(TEXT("name"), Name);
+		Result->SetNumberField(TEXT("samples"), NumSamples);
+		Result->SetNumberField(TEXT("p50Us"), Percentile(0.5));
+		Result->SetNumberField(TEXT("p99Us"), Percentile(0.99));
+		Result->SetNumberField(TEXT("maxUs"), Latencies.IsEmpty() ? 0. : Latencies.Last());
+		Result->SetNumberField(TEXT("meanUs"), NumSamples > 0 ? TotalLatency / NumSamples : 0.);
+		Result->SetNumberField(TEXT("throughputPerSecond"), TotalSeconds > 0. ? NumSamples / TotalSeconds : 0.);
+		Result->SetNumberField(TEXT("allocations"), static_cast<double>(NumAllocations));
+		Result->SetNumberField(TEXT("allocationsPerOp"), NumSamples > 0 ? static_cast<double>(NumAllocations) / NumSamples : 0.);
+		UE_LOG(LogTemp, Display, TEXT("  %-24s p50 %9.2f us  p99 %9.2f us  %10.0f ops/s  %.2f allocs/op"), Name,
+			Percentile(0.5), Percentile(0.99), TotalSeconds > 0. ? NumSamples / TotalSeconds : 0., NumSamples > 0 ? static_cast<double>(NumAllocations) / NumSamples : 0.);
+		return Result;
+	}
+
+	template<typename ValueType>
+	TArray<ValueType> ParseList(const FString& Params, const TCHAR* Name, const TArray<ValueType>& Default)
+	{
+		FString ListString;
+		if(!FParse::Value(*Params, Name, ListString, false))
+		{
+			return Default;
+		}
+		TArray<FString> Entries;
+		ListString.ParseIntoArray(Entries, TEXT(","));
+		TArray<ValueType> Values{};
+		for(const FString& Entry : Entries)
+		{
+			ValueType Value{};
+			LexFromString(Value, *Entry);
+			Values.Add(Value);
+		}
+		return Values;
+	}
+}
+
+UGridBenchmarkCommandlet::UGridBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	HelpDescription = TEXT("Generates seeded grids and writes pathfinding, range, picking, highlight and battle latencies as JSON.");
+	HelpUsage = TEXT("-run=GridBenchmark [-Seed=1] [-Iterations=1000] [-Dimensions=32,64,128,512] [-VolumeDensities=0,0.1,0.3] [-Baseline] [-Output=Path.json]");
+}
+
+int32 UGridBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 Seed = 1;
+	int32 Iterations = 1000;
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	Iterations = FMath::Max(Iterations, 1);
+	const bool bBaseline = FParse::Param(*Params, TEXT("Baseline"));
+	const TArray<int32> Dimensions = ParseList<int32>(Params, TEXT("Dimensions="), {32, 64, 128, 512});
+	const TArray<float> VolumeDensities = ParseList<float>(Params, TEXT("VolumeDensities="), {0.f, 0.1f, 0.3f});
+	FString OutputFilename = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("GridBenchmark-%d.json"), Seed);
+	FParse::Value(*Params, TEXT("Output="), OutputFilename);
+
+	TileMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Plane.Plane"));
+	BlockMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if(TileMesh == nullptr || BlockMesh == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Grid benchmark could not load the engine basic shapes."));
+		return 1;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> ScenarioResults{};
+	int32 ScenarioIndex = 0;
+	for(const int32 Dimension : Dimensions)
+	{
+		for(const float VolumeDensity : VolumeDensities)
+		{
+			//Each scenario has its own stream so adding or skipping one leaves the others unchanged
+			FRandomStream Random{Seed * 7919 + ScenarioIndex++};
+			const FIntVector2 GridDimension{FMath::Max(Dimension, 1), FMath::Max(Dimension, 1)};
+			UE_LOG(LogTemp, Display, TEXT("Grid benchmark %dx%d, volume density %.2f"), GridDimension.X, GridDimension.Y, VolumeDensity);
+
+			UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("GridBenchmark"));
+			FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+			WorldContext.SetCurrentWorld(World);
+			SpawnScenarioLevel(World, GridDimension, VolumeDensity, Random);
+
+			UGridData* GridData = NewObject<UGridData>(GetTransientPackage());
+			GridData->Initialize(GridDimension, TileMesh.Get());
+			AGridActor* GridActor = World->SpawnActor<AGridActor>(FVector{0, 0, GridSpawnHeight}, FRotator::ZeroRotator);
+			GridActor->SetGridData(GridData);
+			const double GenerationMilliseconds = GenerateGrid(World, GridActor);
+
+			TArray<FIntVector2> Tiles{};
+			const FGridTileStore& TileStore = GridActor->GetTileStore();
+			for(TConstSetBitIterator<> It(TileStore.GetTileMask()); It; ++It)
+			{
+				Tiles.Add(TileStore.ToGridIndex(It.GetIndex()));
+			}
+			TSharedRef<FJsonObject> ScenarioResult = MakeShared<FJsonObject>();
+			ScenarioResult->SetNumberField(TEXT("width"), GridDimension.X);
+			ScenarioResult->SetNumberField(TEXT("height"), GridDimension.Y);
+			ScenarioResult->SetNumberField(TEXT("volumeDensity"), VolumeDensity);
+			ScenarioResult->SetNumberField(TEXT("numTiles"), Tiles.Num());
+			ScenarioResult->SetNumberField(TEXT("generationMs"), GenerationMilliseconds);
+			TArray<TSharedPtr<FJsonValue>> WorkloadResults{};
+
+			if(!Tiles.IsEmpty())
+			{
+				const int32 NumWarmup = FMath::Max(Iterations / 10, 1);
+				const uint8 GroundMovement = static_cast<uint8>(EGridMovementType::Ground);
+				const int32 JumpPower = 2;
+				const auto RandomTile = [&Tiles, &Random]() {return Tiles[Random.RandHelper(Tiles.Num())];};
+
+				//Queries are drawn up front so drawing them is not timed and every workload sees the same sequence
+				TArray<TPair<FIntVector2, FIntVector2>> PathQueries{};
+				for(int32 i = 0; i < NumWarmup + Iterations; i++)
+				{
+					PathQueries.Emplace(RandomTile(), RandomTile());
+				}
+				TArray<FIntVector2> OutTiles{};
+				OutTiles.Reserve(TileStore.GetNumCells());
+				WorkloadResults.Add(MakeShared<FJsonValueObject>(RunWorkload(TEXT("FindPath"), Iterations, NumWarmup, [&](const int32 i)
+				{
+					GridActor->FindPath(PathQueries[i].Key, PathQueries[i].Value, OutTiles, GroundMovement, JumpPower);
+				})));
+				if(bBaseline)
+				{
+					//Quadratic in the open list, a sample of the queries is enough to compare against
+					const FGridMovementGraph Graph{TileStore, GroundMovement, JumpPower};
+					TMap<FIntVector2, FBaselinePathNode> Nodes{};
+					Nodes.Reserve(Tiles.Num());
+					for(const FIntVector2& TileIndex : Tiles)
+					{
+						Nodes.Add(TileIndex);
+					}
+					WorkloadResults.Add(MakeShared<FJsonValueObject>(RunWorkload(TEXT("FindPathListBaseline"), FMath::Clamp(Iterations / 10, 1, 100), 0, [&](const int32 i)
+					{
+						FindPathListBaseline(Graph, Nodes, PathQueries[NumWarmup + i].Key, PathQueries[NumWarmup + i].Value, OutTiles);
+					})));
+				}
+				WorkloadResults.Add(MakeShared<FJsonValueObject>(RunWorkload(TEXT("FindPathHierarchical"), Iterations, NumWarmup, [&](const int32 i)
+				{
+					GridActor->FindPathHierarchical(PathQueries[i].Key, PathQueries[i].Value, OutTiles, GroundMovement, JumpPower);
+				})));
+				//A turn's worth of unit ranges from distinct tiles, most of them miss the range cache like a fresh turn would
+				WorkloadResults.Add(MakeShared<FJsonValueObject>(RunWorkload(TEXT("GetWalkableTilesInRange"), Iterations, NumWarmup, [&](const int32 i)
+				{
+					GridActor->GetWalkableTilesInRange(PathQueries[i].Key, 6, OutTiles, GroundMovement, JumpPower);
+				})));
+
+				//Points scattered over the grid surface, the picking left once the cursor ray hit something
+				TArray<FVector> HoverLocations{};
+				const float GridStep = GridActor->GetGridStep();
+				for(int32 i = 0; i < NumWarmup + Iterations; i++)
+				{
+					const FVector2D Point{Random.FRandRange(0.f, GridStep * GridDimension.X), Random.FRandRange(0.f, GridStep * GridDimension.Y)};
+					const FIntVector2 Column{FMath::Clamp(FMath::RoundToInt(Point.X / GridStep), 0, GridDimension.X - 1), FMath::Clamp(FMath::RoundToInt(Point.Y / GridStep), 0, GridDimension.Y - 1)};
+					const float Elevation = TileStore.HasTile(Column) ? TileStore.GetElevation(TileStore.ToTileId(Column)) : 0.f;
+					HoverLocations.Add(GridActor->GetActorTransform().TransformPosition(FVector{Point.X, Point.Y, Elevation}));
+				}
+				int32 NumPicked = 0;
+				WorkloadResults.Add(MakeShared<FJsonValueObject>(RunWorkload(TEXT("HoverPicking"), Iterations, NumWarmup, [&](const int32 i)
+				{
+					NumPicked += GridActor->GetTileIndexAtLocation(HoverLocations[i]).X >= 0 ? 1 : 0;
+				})));
+
+				//Hover moving every frame: previous range unlit, the new one lit and flushed to the chunk components
+				WorkloadResults.Add(MakeShared<FJsonValueObject>(RunWorkload(TEXT("HighlightStorm"), Iterations, NumWarmup, [&](const int32 i)
+				{
+					GridActor->GetTilesInShape(EGridShapeType::Diamond, PathQueries[i].Key, 6, OutTiles);
+					GridActor->SetHighlightedTiles(OutTiles);
+				})));
+				GridActor->SetHighlightedTiles({});
+
+				//Two AI teams on the grid, one sample per team turn
+				FGridBattleSimulation& Simulation = GridActor->GetSimulation();
+				const int32 NumUnits = FMath::Clamp(Tiles.Num() / 64, 2, 32);
+				for(int32 i = 0; i < NumUnits; i++)
+				{
+					FGridAIUnit Unit;
+					Unit.Team = i % 2;
+					Unit.Location = RandomTile();
+					Unit.MovementRange = 5;
+					Unit.MovementType = GroundMovement;
+					Unit.JumpPower = JumpPower;
+					Unit.AttackRange = 1 + i % 3;
+					Unit.AttackPower = 3;
+					Unit.Health = 10;
+					Simulation.AddUnit(Unit);
+				}
+				const int32 NumTurns = FMath::Clamp(Iterations / 10, 1, 100);
+				WorkloadResults.Add(MakeShared<FJsonValueObject>(RunWorkload(TEXT("BattleTurn"), NumTurns, 0, [&](const int32 i)
+				{
+					Simulation.PlayTurn();
+				})));
+				ScenarioResult->SetNumberField(TEXT("battleRounds"), Simulation.GetRound());
+				ScenarioResult->SetNumberField(TEXT("battleWinningTeam"), Simulation.GetWinningTeam());
+				Simulation.Reset();
+			}
+			ScenarioResult->SetArrayField(TEXT("workloads"), WorkloadResults);
+			ScenarioResults.Add(MakeShared<FJsonValueObject>(ScenarioResult));
+
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+	}
+
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetNumberField(TEXT("seed"), Seed);
+	Report->SetNumberField(TEXT("iterations"), Iterations);
+	Report->SetStringField(TEXT("engineVersion"), FEngineVersion::Current().ToString());
+	Report->SetStringField(TEXT("buildConfiguration"), LexToString(FApp::GetBuildConfiguration()));
+	Report->SetArrayField(TEXT("scenarios"), ScenarioResults);
+	FString ReportString;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ReportString);
+	FJsonSerializer::Serialize(Report, Writer);
+	if(!FFileHelper::SaveStringToFile(ReportString, *OutputFilename))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not write the grid benchmark report to %s."), *OutputFilename);
+		return 1;
+	}
+	UE_LOG(LogTemp, Display, TEXT("Grid benchmark report written to %s."), *OutputFilename);
+	return 0;
+}
+
+void UGridBenchmarkCommandlet::SpawnScenarioLevel(UWorld* World, const FIntVector2& Dimension, const float VolumeDensity, FRandomStream& Random) const
+{
+	const float GridStep = TileMesh->GetBoundingBox().GetSize().X;
+	const auto SpawnBlock = [this, World](UClass* BlockClass, const FVector& Min, const FVector& Max) -> AStaticMeshActor*
+	{
+		const FVector Size = Max - Min;
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		AStaticMeshActor* Block = World->SpawnActor<AStaticMeshActor>(BlockClass, FTransform{FRotator::ZeroRotator, (Min + Max) / 2, Size / BasicShapeSize}, SpawnParameters);
+		UStaticMeshComponent* MeshComponent = Block->GetStaticMeshComponent();
+		MeshComponent->SetMobility(EComponentMobility::Movable);
+		MeshComponent->SetStaticMesh(BlockMesh);
+		MeshComponent->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+		MeshComponent->SetCollisionResponseToChannel(ECC_GameTraceChannel1, ECR_Block);
+		return Block;
+	};
+
+	//Ground slab with its top at Z 0, one tile wider than the grid on each side
+	const FVector GridExtent{GridStep * Dimension.X, GridStep * Dimension.Y, 0};
+	SpawnBlock(AStaticMeshActor::StaticClass(), FVector{-GridStep, -GridStep, -BasicShapeSize}, GridExtent + FVector{GridStep, GridStep, 0});
+
+	//Steps of one to three tile heights, over about a tenth of the grid
+	const int32 NumCells = Dimension.X * Dimension.Y;
+	const int32 NumSteps = NumCells / 90;
+	const auto RandomFootprint = [&Random, &Dimension, GridStep](FVector& OutMin, FVector& OutMax)
+	{
+		const FIntVector2 Size{Random.RandRange(2, 4), Random.RandRange(2, 4)};
+		const FIntVector2 Corner{Random.RandRange(0, FMath::Max(Dimension.X - Size.X, 0)), Random.RandRange(0, FMath::Max(Dimension.Y - Size.Y, 0))};
+		//Footprints cover whole columns, a half step around the tile centers they contain
+		OutMin = FVector{GridStep * (Corner.X - 0.5f), GridStep * (Corner.Y - 0.5f), 0};
+		OutMax = FVector{GridStep * (Corner.X + Size.X - 0.5f), GridStep * (Corner.Y + Size.Y - 0.5f), 0};
+	};
+	for(int32 i = 0; i < NumSteps; i++)
+	{
+		FVector Min, Max;
+		RandomFootprint(Min, Max);
+		Max.Z = GridStep * Random.RandRange(1, 3) * 0.5f;
+		SpawnBlock(AStaticMeshActor::StaticClass(), Min, Max);
+	}
+
+	//Thin modifier slabs on the ground, a fifth of them blocking every movement type
+	const int32 NumVolumes = FMath::RoundToInt(VolumeDensity * NumCells / 9.f);
+	for(int32 i = 0; i < NumVolumes; i++)
+	{
+		FVector Min, Max;
+		RandomFootprint(Min, Max);
+		Max.Z = GridStep * 0.1f;
+		AGridModifierVolume* Volume = Cast<AGridModifierVolume>(SpawnBlock(AGridModifierVolume::StaticClass(), Min, Max));
+		FGridModifierVolumeData VolumeSettings;
+		VolumeSettings.ModifiedMovementCost = Random.RandRange(1, 4);
+		VolumeSettings.VolumeAllowedMovement = Random.FRand() < 0.2f ? 0 : static_cast<uint8>(Random.RandRange(1, 7));
+		Volume->SetVolumeSettings(VolumeSettings);
+	}
+}
+
+double UGridBenchmarkCommandlet::GenerateGrid(UWorld* World, AGridActor* GridActor)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	GridActor->SpawnGridAt(GridActor->GetActorLocation(), true, true);
+	//Ground sweeps are resolved by the physics scene during world ticks
+	for(int32 Tick = 0; Tick < MaxGenerationTicks && GridActor->IsGeneratingGrid(); Tick++)
+	{
+		World->Tick(LEVELTICK_All, 1.f / 60.f);
+	}
+	if(GridActor->IsGeneratingGrid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Grid benchmark generation did not complete, the scenario runs on the tiles generated so far."));
+		GridActor->CancelGridGeneration();
+	}
+	return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "GridBenchmarkCommandlet.generated.h"
+
+class AGridActor;
+class UStaticMesh;
+
+/**
+ * Headless grid benchmark. Every scenario builds a seeded level (ground, terrain steps and modifier volumes) in a
+ * transient world, generates the grid through SpawnGridAt and times scripted workloads on it. Results are written as
+ * JSON so they can be compared release to release. Same seed and parameters, same levels and same queries. -Baseline
+ * also times the list-based A* FindPath replaced by the binary heap search, on a sample of the same path queries.
+ *
+ * UnrealEditor-Cmd TacticalRPG -run=GridBenchmark [-Seed=1] [-Iterations=1000] [-Dimensions=32,64,128,512]
+ *     [-VolumeDensities=0,0.1,0.3] [-Baseline] [-Output=Path.json] -nullrhi
+ */
+UCLASS()
+class TACTICALRPG_API UGridBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UGridBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Spawns the level of a scenario into World: a ground slab, terrain steps and modifier volumes covering VolumeDensity of the grid. */
+	void SpawnScenarioLevel(UWorld* World, const FIntVector2& Dimension, float VolumeDensity, FRandomStream& Random) const;
+	/** Generates the environment grid, ticking World until every ground trace reported back. Returns the time it took in milliseconds. */
+	static double GenerateGrid(UWorld* World, AGridActor* GridActor);
+
+	UPROPERTY()
+	TObjectPtr<UStaticMesh> TileMesh{nullptr};
+	UPROPERTY()
+	TObjectPtr<UStaticMesh> BlockMesh{nullptr};
+};
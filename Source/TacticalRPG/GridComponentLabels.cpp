@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridComponentLabels.h"
+
+bool FGridComponentLabels::CanReach(const FGridTileStore& Tiles, const int32 StartId, const int32 GoalId)
+{
+	if(StartId == GoalId)
+	{
+		return true;
+	}
+	const int32 GoalComponent = GetComponent(Tiles, GoalId);
+	if(GoalComponent == INDEX_NONE)
+	{
+		return false;
+	}
+	if(Labels[StartId] != INDEX_NONE)
+	{
+		return FindRoot(Labels[StartId]) == GoalComponent;
+	}
+	//Units may stand on tiles their movement type does not allow, they can still step off to a neighbor
+	const int32 Width = Tiles.GetDimension().X;
+	const int32 NeighborOffsets[4] {-1, 1, -Width, Width};
+	uint32 Mask = Tiles.HasTile(StartId) ? Tiles.GetNeighborMask(StartId, MovementType, JumpPower) : 0;
+	while(Mask != 0)
+	{
+		const int32 NeighborId = StartId + NeighborOffsets[FMath::CountTrailingZeros(Mask)];
+		Mask &= Mask - 1;
+		if(FindRoot(Labels[NeighborId]) == GoalComponent)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+int32 FGridComponentLabels::GetComponent(const FGridTileStore& Tiles, const int32 TileId)
+{
+	Refresh(Tiles);
+	return Labels[TileId] != INDEX_NONE ? FindRoot(Labels[TileId]) : INDEX_NONE;
+}
+
+void FGridComponentLabels::Refresh(const FGridTileStore& Tiles)
+{
+	if(Labels.Num() == Tiles.GetNumCells() && SeenVersion == Tiles.GetVersion())
+	{
+		return;
+	}
+	bool bNeedsRelabel = Labels.Num() != Tiles.GetNumCells();
+	if(!bNeedsRelabel)
+	{
+		const int32 Width = Tiles.GetDimension().X;
+		const bool bReplayed = Tiles.ForEachChangeSince(SeenVersion, [&](const int32 TileId)
+		{
+			if(bNeedsRelabel)
+			{
+				return;
+			}
+			//The neighbor masks of the cells next to a changed tile change with it
+			const int32 X = TileId % Width;
+			bNeedsRelabel = !ApplyCellChange(Tiles, TileId)
+				|| (X > 0 && !ApplyCellChange(Tiles, TileId - 1))
+				|| (X < Width - 1 && !ApplyCellChange(Tiles, TileId + 1))
+				|| (TileId >= Width && !ApplyCellChange(Tiles, TileId - Width))
+				|| (TileId + Width < Tiles.GetNumCells() && !ApplyCellChange(Tiles, TileId + Width));
+		});
+		bNeedsRelabel = bNeedsRelabel || !bReplayed;
+	}
+	if(bNeedsRelabel)
+	{
+		Relabel(Tiles);
+	}
+	SeenVersion = Tiles.GetVersion();
+}
+
+bool FGridComponentLabels::ApplyCellChange(const FGridTileStore& Tiles, const int32 TileId)
+{
+	const bool bIsNode = IsNode(Tiles, TileId);
+	const uint8 Edges = bIsNode ? Tiles.GetNeighborMask(TileId, MovementType, JumpPower) : 0;
+	if((Labels[TileId] != INDEX_NONE && !bIsNode) || (KnownEdges[TileId] & ~Edges) != 0)
+	{
+		return false;
+	}
+	if(bIsNode && Labels[TileId] == INDEX_NONE)
+	{
+		Labels[TileId] = AddLabel();
+	}
+	const int32 Width = Tiles.GetDimension().X;
+	const int32 NeighborOffsets[4] {-1, 1, -Width, Width};
+	uint32 AddedEdges = Edges & ~KnownEdges[TileId];
+	while(AddedEdges != 0)
+	{
+		const int32 NeighborId = TileId + NeighborOffsets[FMath::CountTrailingZeros(AddedEdges)];
+		AddedEdges &= AddedEdges - 1;
+		if(Labels[NeighborId] == INDEX_NONE)
+		{
+			Labels[NeighborId] = AddLabel();
+		}
+		Union(Labels[TileId], Labels[NeighborId]);
+	}
+	KnownEdges[TileId] = Edges;
+	return true;
+}
+
+void FGridComponentLabels::Relabel(const FGridTileStore& Tiles)
+{
+	++NumFullRelabels;
+	const int32 NumCells = Tiles.GetNumCells();
+	const int32 Width = Tiles.GetDimension().X;
+	const int32 NeighborOffsets[4] {-1, 1, -Width, Width};
+	Labels.Init(INDEX_NONE, NumCells);
+	KnownEdges.Init(0, NumCells);
+	LabelParents.Reset();
+	for(TConstSetBitIterator<> It(Tiles.GetTileMask()); It; ++It)
+	{
+		const int32 SeedId = It.GetIndex();
+		if(Labels[SeedId] != INDEX_NONE || !IsNode(Tiles, SeedId))
+		{
+			continue;
+		}
+		const int32 Label = AddLabel();
+		Labels[SeedId] = Label;
+		ScratchStack.Reset();
+		ScratchStack.Add(SeedId);
+		while(!ScratchStack.IsEmpty())
+		{
+			const int32 TileId = ScratchStack.Pop(false);
+			const uint8 Edges = Tiles.GetNeighborMask(TileId, MovementType, JumpPower);
+			KnownEdges[TileId] = Edges;
+			uint32 Mask = Edges;
+			while(Mask != 0)
+			{
+				const int32 NeighborId = TileId + NeighborOffsets[FMath::CountTrailingZeros(Mask)];
+				Mask &= Mask - 1;
+				if(Labels[NeighborId] == INDEX_NONE)
+				{
+					Labels[NeighborId] = Label;
+					ScratchStack.Add(NeighborId);
+				}
+			}
+		}
+	}
+}
+
+int32 FGridComponentLabels::FindRoot(int32 Label)
+{
+	while(LabelParents[Label] != Label)
+	{
+		//Path halving
+		LabelParents[Label] = LabelParents[LabelParents[Label]];
+		Label = LabelParents[Label];
+	}
+	return Label;
+}
+
+void FGridComponentLabels::Union(const int32 LabelA, const int32 LabelB)
+{
+	const int32 RootA = FindRoot(LabelA);
+	const int32 RootB = FindRoot(LabelB);
+	if(RootA != RootB)
+	{
+		LabelParents[FMath::Max(RootA, RootB)] = FMath::Min(RootA, RootB);
+	}
+}
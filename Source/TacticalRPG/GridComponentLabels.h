@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridTileStore.h"
+
+/**
+ * Connected components of the tiles a unit with the given movement rules can stand on. Tiles that allow the movement
+ * type are labelled; two labels belong to the same component when their union-find roots match.
+ * Tile changes that only add connections merge labels in place, changes that may split a component relabel the
+ * whole grid on the next query.
+ */
+class TACTICALRPG_API FGridComponentLabels
+{
+public:
+	FGridComponentLabels(const uint8 InMovementType, const int32 InJumpPower)
+		: MovementType(InMovementType)
+		, JumpPower(InJumpPower)
+	{
+	}
+
+	/** False when no path can lead from StartId to GoalId. O(1) once the labels are up to date. */
+	bool CanReach(const FGridTileStore& Tiles, int32 StartId, int32 GoalId);
+	/** Component of the tile, INDEX_NONE if the movement type cannot stand on it. */
+	int32 GetComponent(const FGridTileStore& Tiles, int32 TileId);
+
+	int32 GetNumFullRelabels() const {return NumFullRelabels;}
+
+private:
+	bool IsNode(const FGridTileStore& Tiles, const int32 TileId) const {return Tiles.HasTile(TileId) && Tiles.IsTileWalkable(TileId, MovementType);}
+
+	/** Brings the labels up to date with the tile store's change log. */
+	void Refresh(const FGridTileStore& Tiles);
+	/** Folds the new state of one cell into the labels. False if the change may have split a component. */
+	bool ApplyCellChange(const FGridTileStore& Tiles, int32 TileId);
+	void Relabel(const FGridTileStore& Tiles);
+
+	int32 AddLabel() {return LabelParents.Add(LabelParents.Num());}
+	int32 FindRoot(int32 Label);
+	void Union(int32 LabelA, int32 LabelB);
+
+	uint8 MovementType;
+	int32 JumpPower;
+
+	//Per cell label, INDEX_NONE for cells the movement type cannot stand on
+	TArray<int32> Labels{};
+	TArray<int32> LabelParents{};
+	//Per cell neighbor mask the labels were computed with
+	TArray<uint8> KnownEdges{};
+	uint32 SeenVersion{0};
+	int32 NumFullRelabels{0};
+	TArray<int32> ScratchStack{};
+};
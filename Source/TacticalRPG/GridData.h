@@ -14,6 +14,12 @@ class TACTICALRPG_API UGridData : public UDataAsset
 {
 	GENERATED_BODY()
 public:
+	/** For grid data built at runtime (tools, benchmarks) rather than authored as an asset. */
+	void Initialize(const FIntVector2& InGridDimension, const TSoftObjectPtr<UStaticMesh>& InTileMesh)
+	{
+		GridDimension = InGridDimension;
+		TileMesh = InTileMesh;
+	}
 
 	const FIntVector2& GetGridDimension() const
 	{
@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridDistanceField.h"
+
+void FGridDistanceField::AddSource(const FGridTileStore& Tiles, const int32 TileId)
+{
+	Refresh(Tiles);
+	Sources.Add(TileId);
+	if(Distances[TileId] == 0)
+	{
+		return;
+	}
+	const FGridMovementGraph Graph{Tiles, MovementType, JumpPower};
+	SetDistance(TileId, 0, TileId);
+	OpenQueue.PushOrUpdate(TileId, 0, 0);
+	Propagate(Graph);
+}
+
+void FGridDistanceField::RemoveSource(const FGridTileStore& Tiles, const int32 TileId)
+{
+	Refresh(Tiles);
+	if(Sources.RemoveSingleSwap(TileId, false) == 0 || Sources.Contains(TileId))
+	{
+		return;
+	}
+	const FGridMovementGraph Graph{Tiles, MovementType, JumpPower};
+
+	//Tiles measured from the removed source form a tree rooted at it, clear them
+	ScratchTiles.Reset();
+	ScratchTiles.Add(TileId);
+	SetDistance(TileId, Unreachable, INDEX_NONE);
+	for(int32 i = 0; i < ScratchTiles.Num(); i++)
+	{
+		Graph.ForEachNeighbor(ScratchTiles[i], [&](const int32 NeighborId)
+		{
+			if(Owners[NeighborId] == TileId)
+			{
+				SetDistance(NeighborId, Unreachable, INDEX_NONE);
+				ScratchTiles.Add(NeighborId);
+			}
+		});
+	}
+	//Then let the surrounding tiles, still measured from other sources, flow back in
+	for(const int32 ClearedId : ScratchTiles)
+	{
+		const int32 EnterCost = Graph.GetEnterCost(ClearedId);
+		int32 BestDistance = Unreachable;
+		int32 BestOwner = INDEX_NONE;
+		Graph.ForEachPredecessor(ClearedId, [&](const int32 PredecessorId)
+		{
+			if(Owners[PredecessorId] != INDEX_NONE && Distances[PredecessorId] + EnterCost < BestDistance)
+			{
+				BestDistance = Distances[PredecessorId] + EnterCost;
+				BestOwner = Owners[PredecessorId];
+			}
+		});
+		if(BestOwner != INDEX_NONE)
+		{
+			SetDistance(ClearedId, BestDistance, BestOwner);
+			OpenQueue.PushOrUpdate(ClearedId, Distances[ClearedId], 0);
+		}
+	}
+	Propagate(Graph);
+}
+
+void FGridDistanceField::MoveSource(const FGridTileStore& Tiles, const int32 FromTileId, const int32 ToTileId)
+{
+	if(FromTileId == ToTileId)
+	{
+		return;
+	}
+	//Add first so the cleared tiles of the old position can flow back from the new one
+	AddSource(Tiles, ToTileId);
+	RemoveSource(Tiles, FromTileId);
+}
+
+void FGridDistanceField::SetSources(const FGridTileStore& Tiles, const TArray<int32>& SourceTileIds)
+{
+	TArray<int32> Removed = Sources;
+	TArray<int32> Added{};
+	for(const int32 TileId : SourceTileIds)
+	{
+		if(Removed.RemoveSingleSwap(TileId, false) == 0)
+		{
+			Added.Add(TileId);
+		}
+	}
+	for(const int32 TileId : Added)
+	{
+		AddSource(Tiles, TileId);
+	}
+	for(const int32 TileId : Removed)
+	{
+		RemoveSource(Tiles, TileId);
+	}
+}
+
+void FGridDistanceField::Refresh(const FGridTileStore& Tiles)
+{
+	if(Distances.Num() == Tiles.GetNumCells() && SeenVersion == Tiles.GetVersion())
+	{
+		return;
+	}
+	if(Distances.Num() != Tiles.GetNumCells())
+	{
+		//Tile ids of another layout mean nothing here
+		Sources.Reset();
+	}
+	Rebuild(FGridMovementGraph{Tiles, MovementType, JumpPower});
+	SeenVersion = Tiles.GetVersion();
+}
+
+void FGridDistanceField::Rebuild(const FGridMovementGraph& Graph)
+{
+	const int32 NumTiles = Graph.GetNumTiles();
+	Distances.Init(Unreachable, NumTiles);
+	Owners.Init(INDEX_NONE, NumTiles);
+	OpenQueue.Reset(NumTiles);
+	for(const int32 SourceId : Sources)
+	{
+		SetDistance(SourceId, 0, SourceId);
+		OpenQueue.PushOrUpdate(SourceId, 0, 0);
+	}
+	Propagate(Graph);
+}
+
+void FGridDistanceField::Propagate(const FGridMovementGraph& Graph)
+{
+	while(!OpenQueue.IsEmpty())
+	{
+		const int32 CurrentId = OpenQueue.Pop();
+		const int32 CurrentDistance = Distances[CurrentId];
+		Graph.ForEachNeighbor(CurrentId, [&](const int32 NeighborId)
+		{
+			const int32 TentativeDistance = FMath::Min(CurrentDistance + Graph.GetEnterCost(NeighborId), Unreachable - 1);
+			if(TentativeDistance < Distances[NeighborId])
+			{
+				SetDistance(NeighborId, TentativeDistance, Owners[CurrentId]);
+				OpenQueue.PushOrUpdate(NeighborId, TentativeDistance, 0);
+			}
+		});
+	}
+}
+
+void FGridDistanceField::SetDistance(const int32 TileId, const int32 Distance, const int32 Owner)
+{
+	Distances[TileId] = static_cast<int16>(FMath::Min(Distance, static_cast<int32>(Unreachable)));
+	Owners[TileId] = Owner;
+}
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPathfinding.h"
+
+/**
+ * Movement cost from the closest of a set of source tiles (a team's units) to every tile of the grid, for one set of
+ * movement rules, computed by a single multi-source Dijkstra. Adding or moving a source only repairs the tiles whose
+ * distance it changes; tile changes in the store rebuild the field on the next access.
+ */
+class TACTICALRPG_API FGridDistanceField
+{
+public:
+	//Stored for tiles no source can reach. Distances saturate one below it
+	static constexpr int16 Unreachable = MAX_int16;
+
+	FGridDistanceField(const uint8 InMovementType, const int32 InJumpPower)
+		: MovementType(InMovementType)
+		, JumpPower(InJumpPower)
+	{
+	}
+
+	void AddSource(const FGridTileStore& Tiles, int32 TileId);
+	void RemoveSource(const FGridTileStore& Tiles, int32 TileId);
+	void MoveSource(const FGridTileStore& Tiles, int32 FromTileId, int32 ToTileId);
+	/** Replaces every source, applying only the difference with the current ones. */
+	void SetSources(const FGridTileStore& Tiles, const TArray<int32>& SourceTileIds);
+
+	int16 GetDistance(const FGridTileStore& Tiles, const int32 TileId) {Refresh(Tiles); return Distances[TileId];}
+	/** Whole field indexed by tile id, for overlays and bulk AI scoring. Valid until the next change. */
+	const TArray<int16>& GetDistances(const FGridTileStore& Tiles) {Refresh(Tiles); return Distances;}
+
+private:
+	/** Rebuilds the field if the tile store changed since it was computed. */
+	void Refresh(const FGridTileStore& Tiles);
+	void Rebuild(const FGridMovementGraph& Graph);
+	/** Dijkstra from every tile currently queued, only ever lowering distances. */
+	void Propagate(const FGridMovementGraph& Graph);
+	void SetDistance(int32 TileId, int32 Distance, int32 Owner);
+
+	uint8 MovementType;
+	int32 JumpPower;
+
+	//Source tile ids, a tile appears once per unit standing on it
+	TArray<int32> Sources{};
+	TArray<int16> Distances{};
+	//Source each tile's distance is measured from, INDEX_NONE when unreachable
+	TArray<int32> Owners{};
+	uint32 SeenVersion{0};
+
+	FGridPriorityQueue OpenQueue{};
+	TArray<int32> ScratchTiles{};
+};
@@ -3,6 +3,8 @@
 
 #include "GridModifierVolume.h"
 
+#include "EngineUtils.h"
+#include "GridActor.h"
 #include "GridUtilities.h"
 
 
@@ -11,6 +13,7 @@ AGridModifierVolume::AGridModifierVolume()
 	AGridModifierVolume::SetActorHiddenInGame(true);
 }
 
+#if WITH_EDITOR
 void AGridModifierVolume::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
 	Super::PostEditChangeProperty(PropertyChangedEvent);
@@ -21,4 +24,48 @@ void AGridModifierVolume::PostEditChangeProperty(FPropertyChangedEvent& Property
 		const FVector ColorValue {BrushColor.R, BrushColor.G, BrushColor.B};
 		GetStaticMeshComponent()->SetVectorParameterValueOnMaterials(TEXT("Color"), ColorValue );
 	}
+	//Slider drags report every frame, the grid only follows once the value is committed
+	if(PropertyChangedEvent.ChangeType != EPropertyChangeType::Interactive)
+	{
+		RegenerateAffectedGrids();
+	}
+}
+
+void AGridModifierVolume::PostEditMove(const bool bFinished)
+{
+	Super::PostEditMove(bFinished);
+
+	//Dragging calls this every frame, the grid only follows once the move is done
+	if(bFinished)
+	{
+		RegenerateAffectedGrids();
+	}
+}
+
+void AGridModifierVolume::PostRegisterAllComponents()
+{
+	Super::PostRegisterAllComponents();
+
+	LastGridBounds = GetComponentsBoundingBox(true);
+}
+
+void AGridModifierVolume::RegenerateAffectedGrids()
+{
+	//Class defaults and Blueprint archetypes are edited without a world
+	if(IsTemplate() || GetWorld() == nullptr)
+	{
+		return;
+	}
+	const FBox Bounds = GetComponentsBoundingBox(true);
+	FBox AffectedBounds = Bounds;
+	if(LastGridBounds.IsValid)
+	{
+		AffectedBounds += LastGridBounds;
+	}
+	LastGridBounds = Bounds;
+	for(TActorIterator<AGridActor> It(GetWorld()); It; ++It)
+	{
+		It->RegenerateRegion(AffectedBounds);
+	}
 }
+#endif
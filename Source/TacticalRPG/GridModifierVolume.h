@@ -11,7 +11,7 @@ USTRUCT(BlueprintType)
 struct FGridModifierVolumeData
 {
 	GENERATED_BODY()
-	UPROPERTY(EditAnywhere)
+	UPROPERTY(EditAnywhere, meta = (ClampMin = 1))
 	int ModifiedMovementCost{1};
 
 	UPROPERTY(EditAnywhere, meta=(Bitmask, BitmaskEnum = "/Script/TacticalRPG.EGridMovementType"))
@@ -30,7 +30,17 @@ class TACTICALRPG_API AGridModifierVolume : public AStaticMeshActor
 	UPROPERTY(EditInstanceOnly)
 	FGridModifierVolumeData VolumeSettings;
 
+#if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostEditMove(bool bFinished) override;
+	virtual void PostRegisterAllComponents() override;
+
+	/** Has every grid actor of the level trace again the tiles under the volume, where it was before the edit included. */
+	void RegenerateAffectedGrids();
+
+	//Bounds the grids were last regenerated for, so tiles the volume moved away from are traced again too
+	FBox LastGridBounds{ForceInit};
+#endif
 
 public:
 	UFUNCTION(meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.EGridMovementType"))
@@ -44,4 +54,6 @@ public:
 
 	UFUNCTION()
 	FGridModifierVolumeData GetVolumeSettings() const {return VolumeSettings;}
+	/** Grids pick the new settings up on their next generation or RegenerateRegion. */
+	void SetVolumeSettings(const FGridModifierVolumeData& InVolumeSettings) {VolumeSettings = InVolumeSettings;}
 };
@@ -0,0 +1,329 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridPathHierarchy.h"
+
+#include "GridStats.h"
+
+namespace
+{
+	//Open border stretches at least this long get an entrance at each end instead of one in the middle
+	constexpr int32 LongEntranceLength = 6;
+	constexpr int32 UnreachableCost = MAX_int32;
+
+	bool IsEntranceTransition(const FGridMovementGraph& Graph, const int32 InsideId, const int32 OutsideId)
+	{
+		return Graph.IsSearchable(InsideId) && Graph.IsSearchable(OutsideId) && (Graph.CanStep(InsideId, OutsideId) || Graph.CanStep(OutsideId, InsideId));
+	}
+}
+
+bool FGridPathHierarchy::FindPath(const FGridTileStore& Tiles, FGridSearchContext& Context, const int32 StartId, const int32 GoalId, TArray<FIntVector2>& OutPath)
+{
+	OutPath.Reset();
+	NumRebuiltClusters = 0;
+	const FGridMovementGraph Graph{Tiles, MovementType, JumpPower};
+	const int32 NumTiles = Graph.GetNumTiles();
+	if(StartId < 0 || StartId >= NumTiles || GoalId < 0 || GoalId >= NumTiles || !Graph.IsSearchable(StartId) || !Tiles.IsTileWalkable(GoalId, MovementType) || !Graph.IsSearchable(GoalId))
+	{
+		return false;
+	}
+	Refresh(Graph, Context);
+
+	const int32 StartClusterId = GetClusterId(Graph.ToGridIndex(StartId));
+	const int32 GoalClusterId = GetClusterId(Graph.ToGridIndex(GoalId));
+	const FCluster& StartCluster = Clusters[StartClusterId];
+	const FCluster& GoalCluster = Clusters[GoalClusterId];
+
+	//Temporary edges linking start and goal to the entrances of their clusters
+	const FGridClusterGraph StartClusterGraph = MakeClusterGraph(Graph, StartClusterId);
+	GetCostsToEntrances(StartClusterGraph, Context, StartId, StartCluster, StartCosts);
+	const int32 DirectCost = StartClusterId == GoalClusterId ? ScratchRange.GetCostTo(Graph.ToGridIndex(GoalId)) : UnreachableCost;
+	GetCostsToEntrances(MakeClusterGraph(Graph, GoalClusterId), Context, GoalId, GoalCluster, GoalCosts);
+	for(int32 Slot = 0; Slot < GoalCosts.Num(); Slot++)
+	{
+		//Searched from the goal outwards; stepping rules are symmetric so only the entered tiles at both ends differ
+		if(GoalCosts[Slot] != UnreachableCost)
+		{
+			GoalCosts[Slot] += Graph.GetEnterCost(GoalId) - Graph.GetEnterCost(GoalCluster.NodeTiles[Slot]);
+		}
+	}
+
+	auto ForEachAbstractEdge = [&](const int32 TileId, auto&& Func)
+	{
+		if(TileId == StartId)
+		{
+			for(int32 Slot = 0; Slot < StartCosts.Num(); Slot++)
+			{
+				if(StartCosts[Slot] != UnreachableCost)
+				{
+					Func(StartCluster.NodeTiles[Slot], StartCosts[Slot]);
+				}
+			}
+			if(DirectCost != UnreachableCost)
+			{
+				Func(GoalId, DirectCost);
+			}
+		}
+		const int32 NodeSlot = NodeSlots[TileId];
+		if(NodeSlot == INDEX_NONE)
+		{
+			return;
+		}
+		const int32 ClusterId = GetClusterId(Graph.ToGridIndex(TileId));
+		const FCluster& Cluster = Clusters[ClusterId];
+		const int32 NumNodes = Cluster.NodeTiles.Num();
+		for(int32 Slot = 0; Slot < NumNodes; Slot++)
+		{
+			const int32 Cost = Cluster.IntraCosts[NodeSlot * NumNodes + Slot];
+			if(Slot != NodeSlot && Cost != UnreachableCost)
+			{
+				Func(Cluster.NodeTiles[Slot], Cost);
+			}
+		}
+		Graph.ForEachNeighbor(TileId, [&](const int32 NeighborId)
+		{
+			if(NodeSlots[NeighborId] != INDEX_NONE && GetClusterId(Graph.ToGridIndex(NeighborId)) != ClusterId)
+			{
+				Func(NeighborId, Graph.GetEnterCost(NeighborId));
+			}
+		});
+		if(ClusterId == GoalClusterId && GoalCosts[NodeSlot] != UnreachableCost)
+		{
+			Func(GoalId, GoalCosts[NodeSlot]);
+		}
+	};
+
+	//A* over the entrances
+	Context.BeginSearch(NumTiles);
+	FGridPriorityQueue& OpenQueue = Context.GetOpenQueue();
+	Context.SetNode(StartId, 0, INDEX_NONE);
+	OpenQueue.PushOrUpdate(StartId, Graph.GetHeuristic(StartId, GoalId), Graph.GetHeuristic(StartId, GoalId));
+	bool bFoundGoal = false;
+	int32 NumExpanded = 0;
+	while(!OpenQueue.IsEmpty())
+	{
+		const int32 CurrentId = OpenQueue.Pop();
+		if(CurrentId == GoalId)
+		{
+			bFoundGoal = true;
+			break;
+		}
+		Context.Close(CurrentId);
+		++NumExpanded;
+		const int32 CurrentG = Context.GetGValue(CurrentId);
+		ForEachAbstractEdge(CurrentId, [&](const int32 NeighborId, const int32 EdgeCost)
+		{
+			if(Context.IsClosed(NeighborId))
+			{
+				return;
+			}
+			const int32 TentativeGValue = CurrentG + EdgeCost;
+			if(TentativeGValue < Context.GetGValue(NeighborId))
+			{
+				Context.SetNode(NeighborId, TentativeGValue, CurrentId);
+				const int32 HValue = Graph.GetHeuristic(NeighborId, GoalId);
+				OpenQueue.PushOrUpdate(NeighborId, TentativeGValue + HValue, HValue);
+			}
+		});
+	}
+	//Entrance nodes, the refinement searches count their own tiles
+	INC_DWORD_STAT_BY(STAT_GridNodesExpanded, NumExpanded);
+	if(!bFoundGoal)
+	{
+		return false;
+	}
+	AbstractPath.Reset();
+	for(int32 TileId = GoalId; TileId != INDEX_NONE; TileId = Context.GetParent(TileId))
+	{
+		AbstractPath.Add(TileId);
+	}
+	Algo::Reverse(AbstractPath);
+
+	//Refine: consecutive entrances are either neighbors across a border or joined by a path inside one cluster
+	OutPath.Emplace(Graph.ToGridIndex(StartId));
+	for(int32 i = 1; i < AbstractPath.Num(); i++)
+	{
+		const int32 FromId = AbstractPath[i - 1];
+		const int32 ToId = AbstractPath[i];
+		const int32 FromClusterId = GetClusterId(Graph.ToGridIndex(FromId));
+		if(FromClusterId != GetClusterId(Graph.ToGridIndex(ToId)))
+		{
+			OutPath.Emplace(Graph.ToGridIndex(ToId));
+			continue;
+		}
+		if(!GridPathfinding::FindPath(MakeClusterGraph(Graph, FromClusterId), Context, FromId, ToId, SegmentPath))
+		{
+			OutPath.Reset();
+			return false;
+		}
+		OutPath.Append(SegmentPath.GetData() + 1, SegmentPath.Num() - 1);
+	}
+	return true;
+}
+
+FGridClusterGraph FGridPathHierarchy::MakeClusterGraph(const FGridMovementGraph& Graph, const int32 ClusterId) const
+{
+	const FIntVector2& Dimension = Graph.Tiles.GetDimension();
+	const FIntVector2 Min {(ClusterId % ClusterGridDimension.X) * ClusterSize, (ClusterId / ClusterGridDimension.X) * ClusterSize};
+	const FIntVector2 Max {FMath::Min(Min.X + ClusterSize, Dimension.X), FMath::Min(Min.Y + ClusterSize, Dimension.Y)};
+	return {Graph, Min, Max};
+}
+
+void FGridPathHierarchy::Refresh(const FGridMovementGraph& Graph, FGridSearchContext& Context)
+{
+	const FGridTileStore& Tiles = Graph.Tiles;
+	const FIntVector2 Dimension = Tiles.GetDimension();
+	const FIntVector2 NewClusterGridDimension {FMath::DivideAndRoundUp(Dimension.X, ClusterSize), FMath::DivideAndRoundUp(Dimension.Y, ClusterSize)};
+	const bool bSameLayout = NewClusterGridDimension == ClusterGridDimension && NodeSlots.Num() == Tiles.GetNumCells();
+	if(!bSameLayout || !Tiles.ForEachChangeSince(SeenVersion, [&](const int32 TileId) {MarkTileChanged(Tiles, TileId);}))
+	{
+		ClusterGridDimension = NewClusterGridDimension;
+		Clusters.Reset();
+		Clusters.SetNum(ClusterGridDimension.X * ClusterGridDimension.Y);
+		NodeSlots.Init(INDEX_NONE, Tiles.GetNumCells());
+	}
+	SeenVersion = Tiles.GetVersion();
+	for(int32 ClusterId = 0; ClusterId < Clusters.Num(); ClusterId++)
+	{
+		if(Clusters[ClusterId].bDirty)
+		{
+			RebuildCluster(Graph, Context, ClusterId);
+		}
+	}
+}
+
+void FGridPathHierarchy::MarkTileChanged(const FGridTileStore& Tiles, const int32 TileId)
+{
+	const FIntVector2 Index = Tiles.ToGridIndex(TileId);
+	Clusters[GetClusterId(Index)].bDirty = true;
+	//Tiles on a cluster edge also decide the entrances of the cluster across it
+	static constexpr int32 NeighborOffsets[4][2] {{-1,0},{1,0},{0,-1},{0,1}};
+	for(const auto& Offset : NeighborOffsets)
+	{
+		const FIntVector2 NeighborIndex {Index.X + Offset[0], Index.Y + Offset[1]};
+		if(Tiles.IsInBounds(NeighborIndex))
+		{
+			Clusters[GetClusterId(NeighborIndex)].bDirty = true;
+		}
+	}
+}
+
+void FGridPathHierarchy::RebuildCluster(const FGridMovementGraph& Graph, FGridSearchContext& Context, const int32 ClusterId)
+{
+	++NumRebuiltClusters;
+	FCluster& Cluster = Clusters[ClusterId];
+	for(const int32 TileId : Cluster.NodeTiles)
+	{
+		NodeSlots[TileId] = INDEX_NONE;
+	}
+	Cluster.NodeTiles.Reset();
+	FindBorderEntrances(Graph, ClusterId, Cluster.NodeTiles);
+	const int32 NumNodes = Cluster.NodeTiles.Num();
+	for(int32 Slot = 0; Slot < NumNodes; Slot++)
+	{
+		NodeSlots[Cluster.NodeTiles[Slot]] = Slot;
+	}
+
+	const FGridClusterGraph ClusterGraph = MakeClusterGraph(Graph, ClusterId);
+	Cluster.IntraCosts.SetNumUninitialized(NumNodes * NumNodes);
+	TArray<int32> NodeCosts{};
+	for(int32 Slot = 0; Slot < NumNodes; Slot++)
+	{
+		GetCostsToEntrances(ClusterGraph, Context, Cluster.NodeTiles[Slot], Cluster, NodeCosts);
+		FMemory::Memcpy(Cluster.IntraCosts.GetData() + Slot * NumNodes, NodeCosts.GetData(), NumNodes * sizeof(int32));
+	}
+	Cluster.bDirty = false;
+}
+
+void FGridPathHierarchy::FindBorderEntrances(const FGridMovementGraph& Graph, const int32 ClusterId, TArray<int32>& OutNodeTiles) const
+{
+	const FGridClusterGraph ClusterGraph = MakeClusterGraph(Graph, ClusterId);
+	const FIntVector2& Min = ClusterGraph.Min;
+	const FIntVector2& Max = ClusterGraph.Max;
+	const FIntVector2& Dimension = Graph.Tiles.GetDimension();
+
+	//Walks one border in increasing coordinate order, which the cluster across it does as well, so both sides agree
+	auto ScanBorder = [&](const int32 Length, auto&& GetPair)
+	{
+		auto AddEntrance = [&](const int32 Position)
+		{
+			int32 InsideId;
+			int32 OutsideId;
+			GetPair(Position, InsideId, OutsideId);
+			OutNodeTiles.AddUnique(InsideId);
+		};
+		int32 RunStart = INDEX_NONE;
+		for(int32 Position = 0; Position <= Length; Position++)
+		{
+			bool bOpen = false;
+			if(Position < Length)
+			{
+				int32 InsideId;
+				int32 OutsideId;
+				GetPair(Position, InsideId, OutsideId);
+				bOpen = IsEntranceTransition(Graph, InsideId, OutsideId);
+			}
+			if(bOpen && RunStart == INDEX_NONE)
+			{
+				RunStart = Position;
+			}
+			else if(!bOpen && RunStart != INDEX_NONE)
+			{
+				const int32 RunEnd = Position - 1;
+				if(RunEnd - RunStart + 1 >= LongEntranceLength)
+				{
+					AddEntrance(RunStart);
+					AddEntrance(RunEnd);
+				}
+				else
+				{
+					AddEntrance((RunStart + RunEnd) / 2);
+				}
+				RunStart = INDEX_NONE;
+			}
+		}
+	};
+
+	if(Min.X > 0)
+	{
+		ScanBorder(Max.Y - Min.Y, [&](const int32 Position, int32& InsideId, int32& OutsideId)
+		{
+			InsideId = Graph.ToTileId({Min.X, Min.Y + Position});
+			OutsideId = InsideId - 1;
+		});
+	}
+	if(Max.X < Dimension.X)
+	{
+		ScanBorder(Max.Y - Min.Y, [&](const int32 Position, int32& InsideId, int32& OutsideId)
+		{
+			InsideId = Graph.ToTileId({Max.X - 1, Min.Y + Position});
+			OutsideId = InsideId + 1;
+		});
+	}
+	if(Min.Y > 0)
+	{
+		ScanBorder(Max.X - Min.X, [&](const int32 Position, int32& InsideId, int32& OutsideId)
+		{
+			InsideId = Graph.ToTileId({Min.X + Position, Min.Y});
+			OutsideId = InsideId - Dimension.X;
+		});
+	}
+	if(Max.Y < Dimension.Y)
+	{
+		ScanBorder(Max.X - Min.X, [&](const int32 Position, int32& InsideId, int32& OutsideId)
+		{
+			InsideId = Graph.ToTileId({Min.X + Position, Max.Y - 1});
+			OutsideId = InsideId + Dimension.X;
+		});
+	}
+}
+
+void FGridPathHierarchy::GetCostsToEntrances(const FGridClusterGraph& ClusterGraph, FGridSearchContext& Context, const int32 FromId, const FCluster& Cluster, TArray<int32>& OutCosts)
+{
+	GridPathfinding::FindReachableTiles(ClusterGraph, Context, FromId, UnreachableCost - 1, ScratchRange);
+	OutCosts.SetNumUninitialized(Cluster.NodeTiles.Num());
+	for(int32 Slot = 0; Slot < Cluster.NodeTiles.Num(); Slot++)
+	{
+		OutCosts[Slot] = ScratchRange.GetCostTo(ClusterGraph.ToGridIndex(Cluster.NodeTiles[Slot]));
+	}
+}
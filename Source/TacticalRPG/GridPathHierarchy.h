@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPathfinding.h"
+
+/**
+ * Movement graph restricted to one rectangular cluster of the grid. Satisfies the GridPathfinding graph contract,
+ * so the flat searches can run inside a cluster.
+ */
+struct TACTICALRPG_API FGridClusterGraph
+{
+	FGridClusterGraph(const FGridMovementGraph& InGraph, const FIntVector2& InMin, const FIntVector2& InMax)
+		: Graph(InGraph)
+		, Min(InMin)
+		, Max(InMax)
+	{
+	}
+
+	int32 GetNumTiles() const {return Graph.GetNumTiles();}
+	int32 GetEnterCost(const int32 TileId) const {return Graph.GetEnterCost(TileId);}
+	int32 GetHeuristic(const int32 FromId, const int32 ToId) const {return Graph.GetHeuristic(FromId, ToId);}
+	FIntVector2 ToGridIndex(const int32 TileId) const {return Graph.ToGridIndex(TileId);}
+
+	bool Contains(const int32 TileId) const
+	{
+		const FIntVector2 Index = Graph.ToGridIndex(TileId);
+		return Index.X >= Min.X && Index.Y >= Min.Y && Index.X < Max.X && Index.Y < Max.Y;
+	}
+
+	template<typename FuncType>
+	void ForEachNeighbor(const int32 TileId, FuncType&& Func) const
+	{
+		Graph.ForEachNeighbor(TileId, [&](const int32 NeighborId)
+		{
+			if(Contains(NeighborId))
+			{
+				Func(NeighborId);
+			}
+		});
+	}
+
+	const FGridMovementGraph& Graph;
+	//Inclusive min, exclusive max
+	FIntVector2 Min;
+	FIntVector2 Max;
+};
+
+/**
+ * HPA* abstraction of a grid for one set of movement rules. The grid is split in square clusters; tiles on both
+ * sides of each open stretch of a cluster border become entrance nodes, and the cheapest in-cluster cost between the
+ * entrances of a cluster is cached. Long routes are searched over entrances only, then refined cluster by cluster.
+ * Clusters are rebuilt lazily, only when a tile inside them (or on their border) changed since the last query.
+ */
+class TACTICALRPG_API FGridPathHierarchy
+{
+public:
+	static constexpr int32 ClusterSize = 16;
+
+	FGridPathHierarchy(const uint8 InMovementType, const int32 InJumpPower)
+		: MovementType(InMovementType)
+		, JumpPower(InJumpPower)
+	{
+	}
+
+	/** Near-optimal path from StartId to GoalId, both included. Context is used for every sub-search in turn. */
+	bool FindPath(const FGridTileStore& Tiles, FGridSearchContext& Context, int32 StartId, int32 GoalId, TArray<FIntVector2>& OutPath);
+
+	//Clusters rebuilt by the last query, zero once the abstraction is warm and the grid is unchanged
+	int32 GetNumRebuiltClusters() const {return NumRebuiltClusters;}
+
+private:
+	struct FCluster
+	{
+		//Entrance tiles of the cluster, local node index -> tile id
+		TArray<int32> NodeTiles{};
+		//Cheapest in-cluster cost from node I to node J at I * NodeTiles.Num() + J, MAX_int32 if unreachable
+		TArray<int32> IntraCosts{};
+		bool bDirty{true};
+	};
+
+	int32 GetClusterId(const FIntVector2& Index) const {return (Index.Y / ClusterSize) * ClusterGridDimension.X + Index.X / ClusterSize;}
+	FGridClusterGraph MakeClusterGraph(const FGridMovementGraph& Graph, int32 ClusterId) const;
+
+	/** Replays tile changes since the last query and rebuilds every cluster they touched. */
+	void Refresh(const FGridMovementGraph& Graph, FGridSearchContext& Context);
+	void MarkTileChanged(const FGridTileStore& Tiles, int32 TileId);
+	void RebuildCluster(const FGridMovementGraph& Graph, FGridSearchContext& Context, int32 ClusterId);
+	void FindBorderEntrances(const FGridMovementGraph& Graph, int32 ClusterId, TArray<int32>& OutNodeTiles) const;
+	/** In-cluster costs from FromId to every entrance of the cluster, MAX_int32 where unreachable. */
+	void GetCostsToEntrances(const FGridClusterGraph& ClusterGraph, FGridSearchContext& Context, int32 FromId, const FCluster& Cluster, TArray<int32>& OutCosts);
+
+	uint8 MovementType;
+	int32 JumpPower;
+
+	FIntVector2 ClusterGridDimension{0,0};
+	TArray<FCluster> Clusters{};
+	//Tile id -> local node index in its cluster, INDEX_NONE for tiles that are not entrances
+	TArray<int32> NodeSlots{};
+	uint32 SeenVersion{0};
+	int32 NumRebuiltClusters{0};
+
+	//Reused between queries
+	FGridMovementRange ScratchRange{};
+	TArray<int32> StartCosts{};
+	TArray<int32> GoalCosts{};
+	TArray<int32> AbstractPath{};
+	TArray<FIntVector2> SegmentPath{};
+};
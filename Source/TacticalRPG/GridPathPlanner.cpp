@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridPathPlanner.h"
+
+#include "GridStats.h"
+
+bool FGridPathPlanner::FindPath(const FGridTileStore& Tiles, const int32 InStartId, const int32 InGoalId, const uint8 InMovementType, const int32 InJumpPower, TArray<FIntVector2>& OutPath)
+{
+	OutPath.Reset();
+	NumExpanded = 0;
+	const int32 NumTiles = Tiles.GetNumCells();
+	if(InStartId < 0 || InStartId >= NumTiles || InGoalId < 0 || InGoalId >= NumTiles)
+	{
+		return false;
+	}
+	const FGridMovementGraph Graph{Tiles, InMovementType, InJumpPower};
+	const bool bSameRoute = GValues.Num() == NumTiles && GoalId == InGoalId && MovementType == InMovementType && JumpPower == InJumpPower;
+	if(bSameRoute && StartId != InStartId)
+	{
+		KeyModifier += Graph.GetHeuristic(StartId, InStartId);
+	}
+	StartId = InStartId;
+	const bool bRepaired = bSameRoute && Tiles.ForEachChangeSince(SeenVersion, [&](const int32 ChangedId)
+	{
+		//Entering the tile, leaving it or stepping between it and a neighbor may have changed
+		UpdateTile(Graph, ChangedId);
+		const int32 Width = Tiles.GetDimension().X;
+		const int32 X = ChangedId % Width;
+		if(X > 0)
+		{
+			UpdateTile(Graph, ChangedId - 1);
+		}
+		if(X < Width - 1)
+		{
+			UpdateTile(Graph, ChangedId + 1);
+		}
+		if(ChangedId >= Width)
+		{
+			UpdateTile(Graph, ChangedId - Width);
+		}
+		if(ChangedId + Width < NumTiles)
+		{
+			UpdateTile(Graph, ChangedId + Width);
+		}
+	});
+	if(!bRepaired)
+	{
+		GoalId = InGoalId;
+		MovementType = InMovementType;
+		JumpPower = InJumpPower;
+		Initialize(Graph);
+	}
+	SeenVersion = Tiles.GetVersion();
+
+	ComputeShortestPath(Graph);
+	INC_DWORD_STAT_BY(STAT_GridNodesExpanded, NumExpanded);
+	return ExtractPath(Graph, OutPath);
+}
+
+void FGridPathPlanner::Reset()
+{
+	OpenQueue.Reset(0);
+	GValues.Reset();
+	RhsValues.Reset();
+	StartId = INDEX_NONE;
+	GoalId = INDEX_NONE;
+	KeyModifier = 0;
+}
+
+void FGridPathPlanner::Initialize(const FGridMovementGraph& Graph)
+{
+	const int32 NumTiles = Graph.GetNumTiles();
+	OpenQueue.Reset(NumTiles);
+	GValues.Init(UnreachableCost, NumTiles);
+	RhsValues.Init(UnreachableCost, NumTiles);
+	KeyModifier = 0;
+	RhsValues[GoalId] = 0;
+	const FKey GoalKey = CalculateKey(Graph, GoalId);
+	OpenQueue.PushOrUpdate(GoalId, GoalKey.Primary, GoalKey.Secondary);
+}
+
+FGridPathPlanner::FKey FGridPathPlanner::CalculateKey(const FGridMovementGraph& Graph, const int32 TileId) const
+{
+	const int32 BestCost = FMath::Min(GValues[TileId], RhsValues[TileId]);
+	return {AddCost(BestCost, Graph.GetHeuristic(StartId, TileId) + KeyModifier), BestCost};
+}
+
+void FGridPathPlanner::UpdateTile(const FGridMovementGraph& Graph, const int32 TileId)
+{
+	if(TileId != GoalId)
+	{
+		int32 BestCost = UnreachableCost;
+		if(Graph.IsSearchable(TileId))
+		{
+			Graph.ForEachNeighbor(TileId, [&](const int32 NeighborId)
+			{
+				BestCost = FMath::Min(BestCost, AddCost(Graph.GetEnterCost(NeighborId), GValues[NeighborId]));
+			});
+		}
+		RhsValues[TileId] = BestCost;
+	}
+	if(GValues[TileId] != RhsValues[TileId])
+	{
+		const FKey Key = CalculateKey(Graph, TileId);
+		OpenQueue.PushOrUpdate(TileId, Key.Primary, Key.Secondary);
+	}
+	else
+	{
+		OpenQueue.Remove(TileId);
+	}
+}
+
+void FGridPathPlanner::ComputeShortestPath(const FGridMovementGraph& Graph)
+{
+	while(!OpenQueue.IsEmpty())
+	{
+		FKey TopKey;
+		const int32 TileId = OpenQueue.Top(TopKey.Primary, TopKey.Secondary);
+		if(!(TopKey < CalculateKey(Graph, StartId)) && RhsValues[StartId] == GValues[StartId])
+		{
+			return;
+		}
+		++NumExpanded;
+		const FKey NewKey = CalculateKey(Graph, TileId);
+		if(TopKey < NewKey)
+		{
+			//Queued before the start moved, requeue with the up to date key
+			OpenQueue.PushOrUpdate(TileId, NewKey.Primary, NewKey.Secondary);
+		}
+		else if(GValues[TileId] > RhsValues[TileId])
+		{
+			GValues[TileId] = RhsValues[TileId];
+			OpenQueue.Remove(TileId);
+			Graph.ForEachPredecessor(TileId, [&](const int32 PredecessorId)
+			{
+				UpdateTile(Graph, PredecessorId);
+			});
+		}
+		else
+		{
+			GValues[TileId] = UnreachableCost;
+			UpdateTile(Graph, TileId);
+			Graph.ForEachPredecessor(TileId, [&](const int32 PredecessorId)
+			{
+				UpdateTile(Graph, PredecessorId);
+			});
+		}
+	}
+}
+
+bool FGridPathPlanner::ExtractPath(const FGridMovementGraph& Graph, TArray<FIntVector2>& OutPath) const
+{
+	if(GValues[StartId] >= UnreachableCost)
+	{
+		return false;
+	}
+	int32 CurrentId = StartId;
+	OutPath.Emplace(Graph.ToGridIndex(CurrentId));
+	//Every step strictly lowers the remaining cost, the bound only guards against a corrupted search
+	for(int32 Step = 0; CurrentId != GoalId; Step++)
+	{
+		int32 NextId = INDEX_NONE;
+		int32 BestCost = UnreachableCost;
+		Graph.ForEachNeighbor(CurrentId, [&](const int32 NeighborId)
+		{
+			const int32 Cost = AddCost(Graph.GetEnterCost(NeighborId), GValues[NeighborId]);
+			if(Cost < BestCost)
+			{
+				BestCost = Cost;
+				NextId = NeighborId;
+			}
+		});
+		if(NextId == INDEX_NONE || Step >= Graph.GetNumTiles())
+		{
+			OutPath.Reset();
+			return false;
+		}
+		CurrentId = NextId;
+		OutPath.Emplace(Graph.ToGridIndex(CurrentId));
+	}
+	return true;
+}
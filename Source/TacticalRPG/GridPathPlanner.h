@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPathfinding.h"
+
+/**
+ * Incremental (D* Lite) route to a fixed goal for one unit. The search runs backwards from the goal and is kept
+ * between queries: when the unit advances or tiles change, only the part of the search those changes invalidated
+ * is repaired instead of planning from scratch. Tile changes are read from the tile store's change log.
+ * Owned by whoever plans for the unit (AI controller, move preview), not thread safe.
+ */
+class TACTICALRPG_API FGridPathPlanner
+{
+public:
+	/**
+	 * Path from StartId to GoalId, both included. Reuses the previous search when the goal and movement rules match
+	 * the last query, otherwise starts over.
+	 */
+	bool FindPath(const FGridTileStore& Tiles, int32 StartId, int32 GoalId, uint8 InMovementType, int32 InJumpPower, TArray<FIntVector2>& OutPath);
+	/** Forgets the kept search, the next query plans from scratch. */
+	void Reset();
+
+	//Tiles expanded by the last query, shows how much of the previous search was reused
+	int32 GetNumExpanded() const {return NumExpanded;}
+
+private:
+	static constexpr int32 UnreachableCost = MAX_int32 / 4;
+
+	struct FKey
+	{
+		int32 Primary;
+		int32 Secondary;
+		bool operator<(const FKey& Other) const {return Primary < Other.Primary || (Primary == Other.Primary && Secondary < Other.Secondary);}
+	};
+
+	void Initialize(const FGridMovementGraph& Graph);
+	FKey CalculateKey(const FGridMovementGraph& Graph, int32 TileId) const;
+	/** Recomputes the one-step lookahead cost of a tile and (re)queues it if it became inconsistent. */
+	void UpdateTile(const FGridMovementGraph& Graph, int32 TileId);
+	void ComputeShortestPath(const FGridMovementGraph& Graph);
+	bool ExtractPath(const FGridMovementGraph& Graph, TArray<FIntVector2>& OutPath) const;
+
+	static int32 AddCost(const int32 A, const int32 B) {return A >= UnreachableCost || B >= UnreachableCost ? UnreachableCost : FMath::Min(A + B, UnreachableCost);}
+
+	FGridPriorityQueue OpenQueue{};
+	TArray<int32> GValues{};
+	TArray<int32> RhsValues{};
+
+	int32 StartId{INDEX_NONE};
+	int32 GoalId{INDEX_NONE};
+	uint8 MovementType{0};
+	int32 JumpPower{0};
+	//Accumulated heuristic drift from the start moving, lets queued keys stay valid without re-sorting
+	int32 KeyModifier{0};
+	//Tile store version the kept search reflects
+	uint32 SeenVersion{0};
+	int32 NumExpanded{0};
+};
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridPathfinding.h"
+
+void FGridPriorityQueue::Reset(const int32 NumTiles)
+{
+	if(HeapSlots.Num() != NumTiles)
+	{
+		HeapSlots.Init(INDEX_NONE, NumTiles);
+	}
+	else
+	{
+		//Popped tiles already cleared their slot, only the leftovers of the last search need resetting
+		for(const FHeapNode& Node : Heap)
+		{
+			HeapSlots[Node.TileId] = INDEX_NONE;
+		}
+	}
+	Heap.Reset();
+}
+
+void FGridPriorityQueue::PushOrUpdate(const int32 TileId, const int32 FValue, const int32 HValue)
+{
+	int32 Slot = HeapSlots[TileId];
+	if(Slot == INDEX_NONE)
+	{
+		Slot = Heap.Add({TileId, FValue, HValue});
+		HeapSlots[TileId] = Slot;
+	}
+	else
+	{
+		Heap[Slot].F = FValue;
+		Heap[Slot].H = HValue;
+	}
+	SiftUp(Slot);
+	SiftDown(HeapSlots[TileId]);
+}
+
+int32 FGridPriorityQueue::Pop()
+{
+	check(!Heap.IsEmpty());
+	const int32 TileId = Heap[0].TileId;
+	SwapSlots(0, Heap.Num() - 1);
+	Heap.Pop(false);
+	HeapSlots[TileId] = INDEX_NONE;
+	if(!Heap.IsEmpty())
+	{
+		SiftDown(0);
+	}
+	return TileId;
+}
+
+int32 FGridPriorityQueue::Top(int32& OutFValue, int32& OutHValue) const
+{
+	check(!Heap.IsEmpty());
+	OutFValue = Heap[0].F;
+	OutHValue = Heap[0].H;
+	return Heap[0].TileId;
+}
+
+void FGridPriorityQueue::Remove(const int32 TileId)
+{
+	const int32 Slot = HeapSlots[TileId];
+	if(Slot == INDEX_NONE)
+	{
+		return;
+	}
+	const int32 LastSlot = Heap.Num() - 1;
+	SwapSlots(Slot, LastSlot);
+	Heap.Pop(false);
+	HeapSlots[TileId] = INDEX_NONE;
+	if(Slot < Heap.Num())
+	{
+		//The former last node now sits in Slot and may belong above or below it
+		const int32 MovedTileId = Heap[Slot].TileId;
+		SiftUp(Slot);
+		SiftDown(HeapSlots[MovedTileId]);
+	}
+}
+
+void FGridPriorityQueue::SiftUp(int32 Slot)
+{
+	while(Slot > 0)
+	{
+		const int32 ParentSlot = (Slot - 1) / 2;
+		if(!IsHigherPriority(Heap[Slot], Heap[ParentSlot]))
+		{
+			return;
+		}
+		SwapSlots(Slot, ParentSlot);
+		Slot = ParentSlot;
+	}
+}
+
+void FGridPriorityQueue::SiftDown(int32 Slot)
+{
+	const int32 Num = Heap.Num();
+	while(true)
+	{
+		const int32 LeftSlot = 2 * Slot + 1;
+		const int32 RightSlot = LeftSlot + 1;
+		int32 BestSlot = Slot;
+		if(LeftSlot < Num && IsHigherPriority(Heap[LeftSlot], Heap[BestSlot]))
+		{
+			BestSlot = LeftSlot;
+		}
+		if(RightSlot < Num && IsHigherPriority(Heap[RightSlot], Heap[BestSlot]))
+		{
+			BestSlot = RightSlot;
+		}
+		if(BestSlot == Slot)
+		{
+			return;
+		}
+		SwapSlots(Slot, BestSlot);
+		Slot = BestSlot;
+	}
+}
+
+void FGridPriorityQueue::SwapSlots(const int32 SlotA, const int32 SlotB)
+{
+	if(SlotA == SlotB)
+	{
+		return;
+	}
+	Heap.Swap(SlotA, SlotB);
+	HeapSlots[Heap[SlotA].TileId] = SlotA;
+	HeapSlots[Heap[SlotB].TileId] = SlotB;
+}
+
+void FGridSearchContext::BeginSearch(const int32 NumTiles)
+{
+	OpenQueue.Reset(NumTiles);
+	if(Stamps.Num() != NumTiles)
+	{
+		Stamps.Init(0, NumTiles);
+		GValues.SetNumUninitialized(NumTiles);
+		Parents.SetNumUninitialized(NumTiles);
+		ClosedSlots.SetNumUninitialized(NumTiles);
+		Generation = 0;
+	}
+	++Generation;
+	if(Generation == 0)
+	{
+		//Stamp counter wrapped around, old stamps could alias the new generation
+		FMemory::Memzero(Stamps.GetData(), Stamps.Num() * sizeof(uint32));
+		Generation = 1;
+	}
+}
+
+void FGridMovementRange::Reset()
+{
+	Tiles.Reset();
+	Costs.Reset();
+	Predecessors.Reset();
+	TileSlots.Reset();
+}
+
+int32 FGridMovementRange::GetCostTo(const FIntVector2& TileIndex) const
+{
+	const int32* Slot = TileSlots.Find(TileIndex);
+	return Slot != nullptr ? Costs[*Slot] : MAX_int32;
+}
+
+bool FGridMovementRange::GetPathTo(const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath) const
+{
+	OutPath.Reset();
+	const int32* TargetSlot = TileSlots.Find(TargetIndex);
+	if(TargetSlot == nullptr)
+	{
+		return false;
+	}
+	for(int32 Slot = *TargetSlot; Slot != INDEX_NONE; Slot = Predecessors[Slot])
+	{
+		OutPath.Emplace(Tiles[Slot]);
+	}
+	Algo::Reverse(OutPath);
+	return true;
+}
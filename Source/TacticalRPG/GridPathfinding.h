@@ -0,0 +1,346 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridStats.h"
+#include "GridTileStore.h"
+#include "GridUtilities.h"
+#include "Algo/Reverse.h"
+
+/**
+ * Binary min-heap over dense tile ids. Keeps a tile id -> heap slot table so a tile that is already open can have
+ * its priority lowered in place (decrease-key) instead of being pushed a second time.
+ */
+class TACTICALRPG_API FGridPriorityQueue
+{
+public:
+	void Reset(int32 NumTiles);
+
+	bool IsEmpty() const {return Heap.IsEmpty();}
+	bool Contains(const int32 TileId) const {return HeapSlots[TileId] != INDEX_NONE;}
+
+	/** Inserts the tile, or moves it to its new priority if it is already queued. */
+	void PushOrUpdate(int32 TileId, int32 FValue, int32 HValue);
+	int32 Pop();
+	/** Highest priority tile and its priority, without removing it. */
+	int32 Top(int32& OutFValue, int32& OutHValue) const;
+	void Remove(int32 TileId);
+
+private:
+	struct FHeapNode
+	{
+		int32 TileId;
+		int32 F;
+		int32 H;
+	};
+
+	//Ties on F are broken towards the node closest to the target, which keeps A* from fanning out on flat terrain
+	static bool IsHigherPriority(const FHeapNode& A, const FHeapNode& B) {return A.F < B.F || (A.F == B.F && A.H < B.H);}
+
+	void SiftUp(int32 Slot);
+	void SiftDown(int32 Slot);
+	void SwapSlots(int32 SlotA, int32 SlotB);
+
+	TArray<FHeapNode> Heap{};
+	TArray<int32> HeapSlots{};
+};
+
+/**
+ * Per-search scratch state (G value, parent, closed slot) for every tile of a grid, plus the open queue.
+ * Entries are stamped with the generation of the search that wrote them, so starting a new search only bumps the
+ * generation instead of clearing the arrays. A context is not thread safe; AI, range previews or worker threads
+ * should each own one and reuse it across queries.
+ */
+class TACTICALRPG_API FGridSearchContext
+{
+public:
+	/** Invalidates every entry written by previous searches. O(1) unless the grid size changed. */
+	void BeginSearch(int32 NumTiles);
+
+	int32 GetGValue(const int32 TileId) const {return IsVisited(TileId) ? GValues[TileId] : MAX_int32;}
+	int32 GetParent(const int32 TileId) const {return IsVisited(TileId) ? Parents[TileId] : INDEX_NONE;}
+	void SetNode(const int32 TileId, const int32 GValue, const int32 Parent)
+	{
+		if(!IsVisited(TileId))
+		{
+			Stamps[TileId] = Generation;
+			ClosedSlots[TileId] = INDEX_NONE;
+		}
+		GValues[TileId] = GValue;
+		Parents[TileId] = Parent;
+	}
+
+	bool IsClosed(const int32 TileId) const {return IsVisited(TileId) && ClosedSlots[TileId] != INDEX_NONE;}
+	/** Closes a visited tile. The slot is free for the caller to use, the flood fill stores the output index there. */
+	void Close(const int32 TileId, const int32 Slot = 0) {ClosedSlots[TileId] = Slot;}
+	int32 GetClosedSlot(const int32 TileId) const {return IsVisited(TileId) ? ClosedSlots[TileId] : INDEX_NONE;}
+
+	FGridPriorityQueue& GetOpenQueue() {return OpenQueue;}
+
+private:
+	bool IsVisited(const int32 TileId) const {return Stamps[TileId] == Generation;}
+
+	FGridPriorityQueue OpenQueue{};
+	TArray<uint32> Stamps{};
+	TArray<int32> GValues{};
+	TArray<int32> Parents{};
+	TArray<int32> ClosedSlots{};
+	uint32 Generation{0};
+};
+
+/**
+ * Result of a bounded movement flood fill: every reachable tile in the order it was settled, the cheapest cost to
+ * enter it and the slot of the tile it is entered from, so the path to any tile in range can be rebuilt without
+ * running another search.
+ */
+struct TACTICALRPG_API FGridMovementRange
+{
+	TArray<FIntVector2> Tiles{};
+	TArray<int32> Costs{};
+	//Slot in Tiles of the previous step, INDEX_NONE for the origin
+	TArray<int32> Predecessors{};
+	TMap<FIntVector2, int32> TileSlots{};
+
+	void Reset();
+	bool Contains(const FIntVector2& TileIndex) const {return TileSlots.Contains(TileIndex);}
+	int32 GetCostTo(const FIntVector2& TileIndex) const;
+	bool GetPathTo(const FIntVector2& TargetIndex, TArray<FIntVector2>& OutPath) const;
+};
+
+/** Identifies a movement range query against one state of the grid, memoized ranges are looked up by it. */
+struct TACTICALRPG_API FGridRangeQueryKey
+{
+	FIntVector2 StartIndex{0,0};
+	int32 MovementRange{0};
+	uint8 MovementType{0};
+	int32 JumpPower{0};
+	//FGridTileStore::GetVersion when the range was computed. Occupants do not block movement, so they are not part of it
+	uint32 GridVersion{0};
+
+	bool operator==(const FGridRangeQueryKey& Other) const
+	{
+		return StartIndex == Other.StartIndex && MovementRange == Other.MovementRange && MovementType == Other.MovementType
+			&& JumpPower == Other.JumpPower && GridVersion == Other.GridVersion;
+	}
+
+	friend uint32 GetTypeHash(const FGridRangeQueryKey& Key)
+	{
+		uint32 Hash = HashCombine(GetTypeHash(Key.StartIndex), GetTypeHash(Key.MovementRange));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint32>(Key.MovementType) | static_cast<uint32>(Key.JumpPower) << 8));
+		return HashCombine(Hash, GetTypeHash(Key.GridVersion));
+	}
+};
+
+/**
+ * Movement rules of one unit applied to tile data: which neighbors it can step to and what entering a tile costs.
+ * An optional filter restricts the search to a subset of the grid. The tile source is the live FGridTileStore on the
+ * game thread or an FGridSnapshot on workers; both expose the same read accessors.
+ */
+template<typename TileSourceType>
+struct TGridMovementGraph
+{
+	TGridMovementGraph(const TileSourceType& InTiles, const uint8 InMovementType, const int32 InJumpPower, const FGridTileFilter& InTileFilter = {})
+		: Tiles(InTiles)
+		, TileFilter(InTileFilter)
+		, MovementType(InMovementType)
+		, JumpPower(InJumpPower)
+		, bUnhinderedByTerrain((InMovementType & static_cast<uint8>(EGridMovementType::Aerial)) != 0)
+		, bUnfiltered(InTileFilter.IsUnrestricted())
+	{
+	}
+
+	int32 GetNumTiles() const {return Tiles.GetNumCells();}
+	int32 ToTileId(const FIntVector2& Index) const {return Tiles.ToTileId(Index);}
+	FIntVector2 ToGridIndex(const int32 TileId) const {return Tiles.ToGridIndex(TileId);}
+	bool IsSearchable(const int32 TileId) const {return Tiles.HasTile(TileId) && TileFilter.Accepts(Tiles, TileId);}
+	bool IsSearchable(const FIntVector2& Index) const {return Tiles.IsInBounds(Index) && IsSearchable(Tiles.ToTileId(Index));}
+
+	int32 GetEnterCost(const int32 TileId) const {return bUnhinderedByTerrain ? 1 : Tiles.GetMovementCost(TileId);}
+
+	int32 GetHeuristic(const int32 FromId, const int32 ToId) const
+	{
+		const FIntVector2 From = ToGridIndex(FromId);
+		const FIntVector2 To = ToGridIndex(ToId);
+		return FMath::Abs(From.X - To.X) + FMath::Abs(From.Y - To.Y);
+	}
+
+	bool CanStep(const int32 FromId, const int32 ToId) const
+	{
+		return IsSearchable(ToId) && Tiles.IsTileWalkable(ToId, MovementType) && FMath::Abs(Tiles.GetHeight(ToId) - Tiles.GetHeight(FromId)) <= JumpPower;
+	}
+
+	//(X-1,Y), (X+1,Y), (X,Y-1), (X,Y+1), read from the store's precomputed neighbor mask
+	template<typename FuncType>
+	void ForEachNeighbor(const int32 TileId, FuncType&& Func) const
+	{
+		const int32 Width = Tiles.GetDimension().X;
+		const int32 NeighborOffsets[4] {-1, 1, -Width, Width};
+		uint32 Mask = Tiles.GetNeighborMask(TileId, MovementType, JumpPower);
+		while(Mask != 0)
+		{
+			const int32 NeighborId = TileId + NeighborOffsets[FMath::CountTrailingZeros(Mask)];
+			Mask &= Mask - 1;
+			if(bUnfiltered || TileFilter.Accepts(Tiles, NeighborId))
+			{
+				Func(NeighborId);
+			}
+		}
+	}
+
+	//Tiles that can step onto TileId, the exact reverse of ForEachNeighbor
+	template<typename FuncType>
+	void ForEachPredecessor(const int32 TileId, FuncType&& Func) const
+	{
+		if(!bUnfiltered && !TileFilter.Accepts(Tiles, TileId))
+		{
+			return;
+		}
+		const int32 Width = Tiles.GetDimension().X;
+		const int32 X = TileId % Width;
+		//Bit of the direction pointing back at TileId from each neighbor
+		if(X > 0 && (Tiles.GetNeighborMask(TileId - 1, MovementType, JumpPower) & 0b0010) != 0)
+		{
+			Func(TileId - 1);
+		}
+		if(X < Width - 1 && (Tiles.GetNeighborMask(TileId + 1, MovementType, JumpPower) & 0b0001) != 0)
+		{
+			Func(TileId + 1);
+		}
+		if(TileId >= Width && (Tiles.GetNeighborMask(TileId - Width, MovementType, JumpPower) & 0b1000) != 0)
+		{
+			Func(TileId - Width);
+		}
+		if(TileId + Width < GetNumTiles() && (Tiles.GetNeighborMask(TileId + Width, MovementType, JumpPower) & 0b0100) != 0)
+		{
+			Func(TileId + Width);
+		}
+	}
+
+	const TileSourceType& Tiles;
+	FGridTileFilter TileFilter;
+	uint8 MovementType;
+	int32 JumpPower;
+	bool bUnhinderedByTerrain;
+	bool bUnfiltered;
+};
+using FGridMovementGraph = TGridMovementGraph<FGridTileStore>;
+
+/**
+ * Searches over a dense tile id space (Id = Y * Width + X). The graph type only has to provide:
+ *   int32 GetNumTiles() const
+ *   int32 GetEnterCost(int32 TileId) const
+ *   int32 GetHeuristic(int32 FromId, int32 ToId) const
+ *   FIntVector2 ToGridIndex(int32 TileId) const
+ *   void ForEachNeighbor(int32 TileId, Func(int32 NeighborId)) const
+ * so the same search runs over any tile storage without virtual calls in the inner loop.
+ */
+namespace GridPathfinding
+{
+	/** A* from StartId to TargetId. OutPath holds the tiles from start to target, both included. */
+	template<typename GraphType>
+	bool FindPath(const GraphType& Graph, FGridSearchContext& Context, const int32 StartId, const int32 TargetId, TArray<FIntVector2>& OutPath)
+	{
+		OutPath.Reset();
+		const int32 NumTiles = Graph.GetNumTiles();
+		if(StartId < 0 || StartId >= NumTiles || TargetId < 0 || TargetId >= NumTiles)
+		{
+			return false;
+		}
+		Context.BeginSearch(NumTiles);
+		FGridPriorityQueue& OpenQueue = Context.GetOpenQueue();
+
+		Context.SetNode(StartId, 0, INDEX_NONE);
+		OpenQueue.PushOrUpdate(StartId, Graph.GetHeuristic(StartId, TargetId), Graph.GetHeuristic(StartId, TargetId));
+		//Counted locally and published once, the stat counters are too heavy for the inner loop
+		int32 NumExpanded = 0;
+		int32 NumNeighborsTested = 0;
+		bool bFoundTarget = false;
+		while(!OpenQueue.IsEmpty())
+		{
+			const int32 CurrentId = OpenQueue.Pop();
+			if(CurrentId == TargetId)
+			{
+				for(int32 TileId = TargetId; TileId != INDEX_NONE; TileId = Context.GetParent(TileId))
+				{
+					OutPath.Emplace(Graph.ToGridIndex(TileId));
+				}
+				Algo::Reverse(OutPath);
+				bFoundTarget = true;
+				break;
+			}
+			Context.Close(CurrentId);
+			++NumExpanded;
+			const int32 CurrentG = Context.GetGValue(CurrentId);
+			Graph.ForEachNeighbor(CurrentId, [&](const int32 NeighborId)
+			{
+				++NumNeighborsTested;
+				if(Context.IsClosed(NeighborId))
+				{
+					return;
+				}
+				const int32 TentativeGValue = CurrentG + Graph.GetEnterCost(NeighborId);
+				if(TentativeGValue < Context.GetGValue(NeighborId))
+				{
+					Context.SetNode(NeighborId, TentativeGValue, CurrentId);
+					const int32 HValue = Graph.GetHeuristic(NeighborId, TargetId);
+					OpenQueue.PushOrUpdate(NeighborId, TentativeGValue + HValue, HValue);
+				}
+			});
+		}
+		INC_DWORD_STAT_BY(STAT_GridNodesExpanded, NumExpanded);
+		INC_DWORD_STAT_BY(STAT_GridNeighborsTested, NumNeighborsTested);
+		return bFoundTarget;
+	}
+
+	/**
+	 * Uniform-cost (Dijkstra) flood fill that never opens a tile costing more than MaxCost.
+	 * One pass yields the whole reachable set with per-tile cost and predecessor.
+	 */
+	template<typename GraphType>
+	void FindReachableTiles(const GraphType& Graph, FGridSearchContext& Context, const int32 StartId, const int32 MaxCost, FGridMovementRange& OutRange)
+	{
+		OutRange.Reset();
+		const int32 NumTiles = Graph.GetNumTiles();
+		if(StartId < 0 || StartId >= NumTiles || MaxCost < 0)
+		{
+			return;
+		}
+		Context.BeginSearch(NumTiles);
+		FGridPriorityQueue& OpenQueue = Context.GetOpenQueue();
+
+		Context.SetNode(StartId, 0, INDEX_NONE);
+		OpenQueue.PushOrUpdate(StartId, 0, 0);
+		int32 NumNeighborsTested = 0;
+		while(!OpenQueue.IsEmpty())
+		{
+			const int32 CurrentId = OpenQueue.Pop();
+			const int32 CurrentG = Context.GetGValue(CurrentId);
+			const int32 ParentId = Context.GetParent(CurrentId);
+			const FIntVector2 CurrentIndex = Graph.ToGridIndex(CurrentId);
+			const int32 Slot = OutRange.Tiles.Emplace(CurrentIndex);
+			Context.Close(CurrentId, Slot);
+			OutRange.Costs.Emplace(CurrentG);
+			OutRange.Predecessors.Emplace(ParentId == INDEX_NONE ? INDEX_NONE : Context.GetClosedSlot(ParentId));
+			OutRange.TileSlots.Emplace(CurrentIndex, Slot);
+
+			Graph.ForEachNeighbor(CurrentId, [&](const int32 NeighborId)
+			{
+				++NumNeighborsTested;
+				if(Context.IsClosed(NeighborId))
+				{
+					return;
+				}
+				const int32 TentativeGValue = CurrentG + Graph.GetEnterCost(NeighborId);
+				if(TentativeGValue <= MaxCost && TentativeGValue < Context.GetGValue(NeighborId))
+				{
+					Context.SetNode(NeighborId, TentativeGValue, CurrentId);
+					OpenQueue.PushOrUpdate(NeighborId, TentativeGValue, 0);
+				}
+			});
+		}
+		//Every tile of the range was expanded exactly once
+		INC_DWORD_STAT_BY(STAT_GridNodesExpanded, OutRange.Tiles.Num());
+		INC_DWORD_STAT_BY(STAT_GridNeighborsTested, NumNeighborsTested);
+	}
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GridAllocationCounter.h"
+#include "GridPathfinding.h"
+#include "GridTileStore.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGridFindPathAllocationTest, "TacticalRPG.Grid.FindPath.ZeroAllocations64x64", EAutomationTestFlags::EditorContext | EAutomationTestFlags::CommandletContext | EAutomationTestFlags::EngineFilter)
+
+bool FGridFindPathAllocationTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 GridSize = 64;
+	constexpr int32 NumQueries = 256;
+
+	//Seeded terrain with mixed costs, heights and gaps so searches expand a good part of the grid
+	FRandomStream Random{64};
+	FGridTileStore TileStore{};
+	TileStore.Init({GridSize, GridSize});
+	for(int32 TileId = 0; TileId < GridSize * GridSize; TileId++)
+	{
+		if(Random.FRand() < 0.1f)
+		{
+			continue;
+		}
+		TileStore.AddTile(TileId, TileId, Random.RandRange(1, 3), static_cast<uint8>(EGridMovementType::Ground), Random.RandRange(0, 1));
+	}
+
+	TArray<TPair<int32, int32>> Queries{};
+	Queries.Reserve(NumQueries);
+	while(Queries.Num() < NumQueries)
+	{
+		const int32 StartId = Random.RandRange(0, GridSize * GridSize - 1);
+		const int32 TargetId = Random.RandRange(0, GridSize * GridSize - 1);
+		if(TileStore.HasTile(StartId) && TileStore.HasTile(TargetId))
+		{
+			Queries.Emplace(StartId, TargetId);
+		}
+	}
+
+	const FGridMovementGraph Graph{TileStore, static_cast<uint8>(EGridMovementType::Ground), 1};
+	FGridSearchContext SearchContext{};
+	TArray<FIntVector2> OutPath{};
+	OutPath.Reserve(GridSize * GridSize);
+
+	//First pass sizes the context and heap, later searches only reuse them
+	int32 NumFound = 0;
+	for(const TPair<int32, int32>& Query : Queries)
+	{
+		NumFound += GridPathfinding::FindPath(Graph, SearchContext, Query.Key, Query.Value, OutPath) ? 1 : 0;
+	}
+	TestTrue(TEXT("Some queries find a path"), NumFound > 0);
+
+	uint64 NumAllocations = 0;
+	{
+		const FGridAllocationScope AllocationScope{};
+		for(const TPair<int32, int32>& Query : Queries)
+		{
+			GridPathfinding::FindPath(Graph, SearchContext, Query.Key, Query.Value, OutPath);
+		}
+		NumAllocations = AllocationScope.GetNumAllocations();
+	}
+	if(NumAllocations != 0)
+	{
+		AddError(FString::Printf(TEXT("Warm FindPath calls made %llu game thread allocations over %d queries, expected none."), NumAllocations, NumQueries));
+	}
+
+	return true;
+}
+
+#endif
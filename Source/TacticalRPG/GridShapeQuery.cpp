@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridShapeQuery.h"
+
+namespace
+{
+	//Len (at most 63) bits of the mask starting at bit Start
+	uint64 ReadMaskBits(const uint32* Words, const int32 NumWords, const int32 Start, const int32 Len)
+	{
+		const int32 WordIndex = Start >> 5;
+		const int32 Shift = Start & 31;
+		uint64 Bits = Words[WordIndex];
+		if(WordIndex + 1 < NumWords)
+		{
+			Bits |= static_cast<uint64>(Words[WordIndex + 1]) << 32;
+		}
+		Bits >>= Shift;
+		if(Shift != 0 && WordIndex + 2 < NumWords)
+		{
+			Bits |= static_cast<uint64>(Words[WordIndex + 2]) << (64 - Shift);
+		}
+		return Bits & ((1ull << Len) - 1);
+	}
+
+	template<typename FilterType>
+	int32 FindMaskedTiles(const TBitArray<>& TileMask, const FIntVector2& Dimension, const FGridShapeStencil& Stencil, const FIntVector2& Center,
+		const TArrayView<int32> OutTileIds, FilterType&& Filter)
+	{
+		if(TileMask.Num() != Dimension.X * Dimension.Y || TileMask.Num() == 0)
+		{
+			return 0;
+		}
+		const int32 NumWords = FMath::DivideAndRoundUp(TileMask.Num(), 32);
+		const uint32* Words = TileMask.GetData();
+		const int32 Radius = Stencil.Radius;
+		int32 NumFound = 0;
+		for(int32 Row = 0; Row <= 2 * Radius; Row++)
+		{
+			const int32 Y = Center.Y + Row - Radius;
+			uint64 RowBits = Stencil.Rows[Row];
+			if(RowBits == 0 || Y < 0 || Y >= Dimension.Y)
+			{
+				continue;
+			}
+			//Clip the row to the grid, the stencil's bit 0 sits on column Center.X - Radius
+			int32 StartX = Center.X - Radius;
+			if(StartX < 0)
+			{
+				if(-StartX > 2 * Radius)
+				{
+					continue;
+				}
+				RowBits >>= -StartX;
+				StartX = 0;
+			}
+			const int32 Len = FMath::Min(Center.X + Radius - StartX + 1, Dimension.X - StartX);
+			if(Len <= 0)
+			{
+				continue;
+			}
+			const int32 RowStartId = Y * Dimension.X + StartX;
+			RowBits &= ReadMaskBits(Words, NumWords, RowStartId, Len);
+			while(RowBits != 0)
+			{
+				const int32 TileId = RowStartId + static_cast<int32>(FMath::CountTrailingZeros64(RowBits));
+				RowBits &= RowBits - 1;
+				if(!Filter(TileId))
+				{
+					continue;
+				}
+				if(NumFound == OutTileIds.Num())
+				{
+					return NumFound;
+				}
+				OutTileIds[NumFound++] = TileId;
+			}
+		}
+		return NumFound;
+	}
+}
+
+int32 FGridShapeStencil::GetNumTiles() const
+{
+	int32 NumTiles = 0;
+	for(int32 Row = 0; Row <= 2 * Radius; Row++)
+	{
+		NumTiles += FMath::CountBits(Rows[Row]);
+	}
+	return NumTiles;
+}
+
+int32 GridShapeQuery::FindTiles(const FGridTileStore& Tiles, const FGridShapeStencil& Stencil, const FIntVector2& Center, const TArrayView<int32> OutTileIds,
+	const int32 MaxHeightDelta)
+{
+	if(MaxHeightDelta < 0 || !Tiles.HasTile(Center))
+	{
+		return FindMaskedTiles(Tiles.GetTileMask(), Tiles.GetDimension(), Stencil, Center, OutTileIds, [](const int32) {return true;});
+	}
+	const int32 CenterHeight = Tiles.GetHeight(Tiles.ToTileId(Center));
+	return FindMaskedTiles(Tiles.GetTileMask(), Tiles.GetDimension(), Stencil, Center, OutTileIds, [&Tiles, CenterHeight, MaxHeightDelta](const int32 TileId)
+	{
+		return FMath::Abs(Tiles.GetHeight(TileId) - CenterHeight) <= MaxHeightDelta;
+	});
+}
+
+int32 GridShapeQuery::FindTiles(const TBitArray<>& TileMask, const FIntVector2& Dimension, const FGridShapeStencil& Stencil, const FIntVector2& Center,
+	const TArrayView<int32> OutTileIds)
+{
+	return FindMaskedTiles(TileMask, Dimension, Stencil, Center, OutTileIds, [](const int32) {return true;});
+}
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridTileStore.h"
+#include "GridUtilities.h"
+
+/**
+ * Footprint of a shape as one 64 bit mask per row of offsets around its center: bit X + Radius of row Y + Radius is set
+ * when offset (X, Y) is covered. Plain data built in constant time per cell, so abilities can keep theirs as constexpr
+ * values and queries never rebuild or allocate one.
+ */
+struct TACTICALRPG_API FGridShapeStencil
+{
+	//Widest row that fits in a mask
+	static constexpr int32 MaxRadius = 31;
+	static constexpr int32 MaxSize = 2 * MaxRadius + 1;
+
+	int32 Radius{0};
+	uint64 Rows[MaxSize]{};
+
+	/** Radius is clamped to MaxRadius. Direction only matters for lines and cones, InnerRadius only for rings. */
+	static constexpr FGridShapeStencil Make(const EGridShapeType Type, const int32 InRadius, const EGridDirection Direction = EGridDirection::PositiveX, const int32 InnerRadius = 0)
+	{
+		FGridShapeStencil Stencil;
+		Stencil.Radius = InRadius < 0 ? 0 : (InRadius > MaxRadius ? MaxRadius : InRadius);
+		for(int32 OffsetY = -Stencil.Radius; OffsetY <= Stencil.Radius; OffsetY++)
+		{
+			for(int32 OffsetX = -Stencil.Radius; OffsetX <= Stencil.Radius; OffsetX++)
+			{
+				if(Covers(Type, Stencil.Radius, Direction, InnerRadius, OffsetX, OffsetY))
+				{
+					Stencil.Rows[OffsetY + Stencil.Radius] |= 1ull << (OffsetX + Stencil.Radius);
+				}
+			}
+		}
+		return Stencil;
+	}
+
+	constexpr bool Contains(const int32 OffsetX, const int32 OffsetY) const
+	{
+		return OffsetX >= -Radius && OffsetX <= Radius && OffsetY >= -Radius && OffsetY <= Radius
+			&& (Rows[OffsetY + Radius] & 1ull << (OffsetX + Radius)) != 0;
+	}
+
+	/** Number of offsets covered, the most tiles a query can return. */
+	int32 GetNumTiles() const;
+
+private:
+	static constexpr int32 Abs(const int32 Value) {return Value < 0 ? -Value : Value;}
+
+	static constexpr bool Covers(const EGridShapeType Type, const int32 Radius, const EGridDirection Direction, const int32 InnerRadius, const int32 OffsetX, const int32 OffsetY)
+	{
+		const int32 Distance = Abs(OffsetX) + Abs(OffsetY);
+		//Offsets along Direction and across it, for the directed shapes
+		const bool bAlongX = Direction == EGridDirection::PositiveX || Direction == EGridDirection::NegativeX;
+		const bool bNegative = Direction == EGridDirection::NegativeX || Direction == EGridDirection::NegativeY;
+		const int32 Forward = (bAlongX ? OffsetX : OffsetY) * (bNegative ? -1 : 1);
+		const int32 Lateral = Abs(bAlongX ? OffsetY : OffsetX);
+		switch(Type)
+		{
+		case EGridShapeType::Diamond:
+			return Distance <= Radius;
+		case EGridShapeType::Square:
+			return true;
+		case EGridShapeType::Circle:
+			//R * (R + 1) instead of R * R keeps a single tile bump off each axis end
+			return OffsetX * OffsetX + OffsetY * OffsetY <= Radius * (Radius + 1);
+		case EGridShapeType::Cross:
+			return OffsetX == 0 || OffsetY == 0;
+		case EGridShapeType::Ring:
+			return Distance <= Radius && Distance >= InnerRadius;
+		case EGridShapeType::Line:
+			return Lateral == 0 && Forward >= 1;
+		case EGridShapeType::Cone:
+			return Forward >= 1 && Lateral < Forward;
+		}
+		return false;
+	}
+};
+
+/**
+ * Tiles covered by a stencil placed on a grid. Each stencil row is intersected with the matching run of the tile mask
+ * a word at a time, only the surviving bits are visited. Results go row by row into a buffer the caller owns; when it
+ * is too small the query stops once it is full.
+ */
+namespace GridShapeQuery
+{
+	/**
+	 * Tile ids of the store covered by the stencil centered on Center, returns how many were written to OutTileIds.
+	 * A MaxHeightDelta of 0 or more keeps only tiles whose height is that close to the center tile's, if the center has one.
+	 */
+	TACTICALRPG_API int32 FindTiles(const FGridTileStore& Tiles, const FGridShapeStencil& Stencil, const FIntVector2& Center, TArrayView<int32> OutTileIds, int32 MaxHeightDelta = -1);
+
+	/** Same against any mask laid out like tile ids, e.g. the tiles occupied by one team. */
+	TACTICALRPG_API int32 FindTiles(const TBitArray<>& TileMask, const FIntVector2& Dimension, const FGridShapeStencil& Stencil, const FIntVector2& Center, TArrayView<int32> OutTileIds);
+}
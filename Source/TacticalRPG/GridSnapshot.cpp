@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridSnapshot.h"
+
+TSharedRef<const FGridSnapshot, ESPMode::ThreadSafe> FGridSnapshot::Create(const FGridTileStore& Tiles, const FGridSnapshot* Previous)
+{
+	const TSharedRef<FGridSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FGridSnapshot, ESPMode::ThreadSafe>();
+	Snapshot->Revision = Tiles.GetRevision();
+	Snapshot->Version = Tiles.GetVersion();
+	Snapshot->Dimension = Tiles.GetDimension();
+	Snapshot->ChunksX = Tiles.GetChunkGridDimension().X;
+	const int32 NumChunks = Tiles.GetNumChunks();
+	const bool bCanShare = Previous != nullptr && Previous->Dimension == Snapshot->Dimension;
+	Snapshot->Chunks.Reserve(NumChunks);
+	Snapshot->ChunkRevisions.Reserve(NumChunks);
+	for(int32 ChunkId = 0; ChunkId < NumChunks; ChunkId++)
+	{
+		const uint32 ChunkRevision = Tiles.GetChunkRevision(ChunkId);
+		Snapshot->Chunks.Add(bCanShare && Previous->ChunkRevisions[ChunkId] == ChunkRevision ? Previous->Chunks[ChunkId] : CopyChunk(Tiles, ChunkId));
+		Snapshot->ChunkRevisions.Add(ChunkRevision);
+	}
+	return Snapshot;
+}
+
+FGridSnapshotChunkRef FGridSnapshot::CopyChunk(const FGridTileStore& Tiles, const int32 ChunkId)
+{
+	const TSharedRef<FGridSnapshotChunk, ESPMode::ThreadSafe> Chunk = MakeShared<FGridSnapshotChunk, ESPMode::ThreadSafe>();
+	Chunk->TileMask.Init(false, FGridSnapshotChunk::NumCells);
+	Chunk->MovementCost.Init(1, FGridSnapshotChunk::NumCells);
+	Chunk->Height.Init(1, FGridSnapshotChunk::NumCells);
+	Chunk->AllowedMovementTypes.Init(0, FGridSnapshotChunk::NumCells);
+	Chunk->TileState.Init(0, FGridSnapshotChunk::NumCells);
+	Chunk->Occupant.Init(INDEX_NONE, FGridSnapshotChunk::NumCells);
+	Chunk->TypeNeighborMasks.Init(0, FGridSnapshotChunk::NumCells);
+	Chunk->JumpNeighborMasks.Init(0, FGridSnapshotChunk::NumCells);
+	Chunk->SteepNeighborMasks.Init(0, FGridSnapshotChunk::NumCells);
+	const int32 Width = Tiles.GetDimension().X;
+	Tiles.ForEachCellInChunk(ChunkId, [&](const int32 TileId)
+	{
+		const int32 Cell = ((TileId / Width) % FGridTileStore::ChunkSize) * FGridTileStore::ChunkSize + (TileId % Width) % FGridTileStore::ChunkSize;
+		Chunk->TileMask[Cell] = Tiles.TileMask[TileId];
+		Chunk->MovementCost[Cell] = Tiles.MovementCost[TileId];
+		Chunk->Height[Cell] = Tiles.Height[TileId];
+		Chunk->AllowedMovementTypes[Cell] = Tiles.AllowedMovementTypes[TileId];
+		Chunk->TileState[Cell] = Tiles.TileState[TileId];
+		Chunk->Occupant[Cell] = Tiles.Occupant[TileId];
+		Chunk->TypeNeighborMasks[Cell] = Tiles.TypeNeighborMasks[TileId];
+		Chunk->JumpNeighborMasks[Cell] = Tiles.JumpNeighborMasks[TileId];
+		Chunk->SteepNeighborMasks[Cell] = Tiles.SteepNeighborMasks[TileId];
+	});
+	return Chunk;
+}
+
+uint8 FGridSnapshot::GetNeighborMask(const int32 TileId, const uint8 MoveTypes, const int32 JumpPower) const
+{
+	if(JumpPower < 0)
+	{
+		return 0;
+	}
+	int32 Cell;
+	const FGridSnapshotChunk& Chunk = GetCellChunk(TileId, Cell);
+	uint8 SteepMask = 0;
+	if(JumpPower >= FGridTileStore::NumJumpBuckets - 1 && Chunk.SteepNeighborMasks[Cell] != 0)
+	{
+		const int32 NeighborOffsets[4] {-1, 1, -Dimension.X, Dimension.X};
+		for(int32 Direction = 0; Direction < 4; Direction++)
+		{
+			if((Chunk.SteepNeighborMasks[Cell] & (1 << Direction)) != 0 && FMath::Abs(GetHeight(TileId + NeighborOffsets[Direction]) - Chunk.Height[Cell]) <= JumpPower)
+			{
+				SteepMask |= 1 << Direction;
+			}
+		}
+	}
+	return FGridTileStore::CombineNeighborMasks(Chunk.TypeNeighborMasks[Cell], Chunk.JumpNeighborMasks[Cell], SteepMask, MoveTypes, JumpPower);
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridTileStore.h"
+
+/** Tile data of one FGridTileStore chunk, frozen when it was copied. Cells are indexed (Y % ChunkSize) * ChunkSize + X % ChunkSize. */
+struct TACTICALRPG_API FGridSnapshotChunk
+{
+	static constexpr int32 NumCells = FGridTileStore::ChunkSize * FGridTileStore::ChunkSize;
+
+	TBitArray<> TileMask{};
+	TArray<int32> MovementCost{};
+	TArray<int32> Height{};
+	TArray<uint8> AllowedMovementTypes{};
+	TArray<uint8> TileState{};
+	TArray<int32> Occupant{};
+	TArray<uint32> TypeNeighborMasks{};
+	TArray<uint64> JumpNeighborMasks{};
+	TArray<uint8> SteepNeighborMasks{};
+};
+
+using FGridSnapshotChunkRef = TSharedRef<const FGridSnapshotChunk, ESPMode::ThreadSafe>;
+
+/**
+ * Immutable, versioned view of a tile store for readers on other threads. Chunks are shared between versions: taking
+ * a new snapshot only copies the chunks the store changed since the previous one. Readers pin a version by holding
+ * its shared reference, no locks involved. Exposes the read accessors of FGridTileStore, so the movement graph and
+ * searches run on it unchanged.
+ */
+class TACTICALRPG_API FGridSnapshot
+{
+public:
+	/** Snapshot of the store's current state, sharing every chunk of Previous that did not change since it was taken. */
+	static TSharedRef<const FGridSnapshot, ESPMode::ThreadSafe> Create(const FGridTileStore& Tiles, const FGridSnapshot* Previous);
+
+	//Store revision the snapshot was taken at, stale once it differs from FGridTileStore::GetRevision
+	uint32 GetRevision() const {return Revision;}
+	//Store movement version at the time, see FGridTileStore::GetVersion
+	uint32 GetVersion() const {return Version;}
+
+	const FIntVector2& GetDimension() const {return Dimension;}
+	int32 GetNumCells() const {return Dimension.X * Dimension.Y;}
+	int32 GetNumChunks() const {return Chunks.Num();}
+	const FGridSnapshotChunkRef& GetChunk(const int32 ChunkId) const {return Chunks[ChunkId];}
+
+	bool IsInBounds(const FIntVector2& Index) const {return Index.X >= 0 && Index.Y >= 0 && Index.X < Dimension.X && Index.Y < Dimension.Y;}
+	int32 ToTileId(const FIntVector2& Index) const {return Index.Y * Dimension.X + Index.X;}
+	FIntVector2 ToGridIndex(const int32 TileId) const {return {TileId % Dimension.X, TileId / Dimension.X};}
+
+	bool HasTile(const int32 TileId) const {int32 Cell; return GetCellChunk(TileId, Cell).TileMask[Cell];}
+	bool HasTile(const FIntVector2& Index) const {return IsInBounds(Index) && HasTile(ToTileId(Index));}
+	int32 GetMovementCost(const int32 TileId) const {int32 Cell; return GetCellChunk(TileId, Cell).MovementCost[Cell];}
+	int32 GetHeight(const int32 TileId) const {int32 Cell; return GetCellChunk(TileId, Cell).Height[Cell];}
+	uint8 GetAllowedMovementTypes(const int32 TileId) const {int32 Cell; return GetCellChunk(TileId, Cell).AllowedMovementTypes[Cell];}
+	bool IsTileWalkable(const int32 TileId, const uint8 MoveTypeToCheck) const {return (GetAllowedMovementTypes(TileId) & MoveTypeToCheck) != 0;}
+	uint8 GetTileState(const int32 TileId) const {int32 Cell; return GetCellChunk(TileId, Cell).TileState[Cell];}
+	int32 GetOccupant(const int32 TileId) const {int32 Cell; return GetCellChunk(TileId, Cell).Occupant[Cell];}
+	bool IsTileOccupied(const int32 TileId) const {return GetOccupant(TileId) != INDEX_NONE;}
+
+	uint8 GetNeighborMask(const int32 TileId, const uint8 MoveTypes, const int32 JumpPower) const;
+
+private:
+	const FGridSnapshotChunk& GetCellChunk(const int32 TileId, int32& OutCell) const
+	{
+		const int32 X = TileId % Dimension.X;
+		const int32 Y = TileId / Dimension.X;
+		constexpr int32 ChunkSize = FGridTileStore::ChunkSize;
+		OutCell = (Y % ChunkSize) * ChunkSize + X % ChunkSize;
+		return *Chunks[(Y / ChunkSize) * ChunksX + X / ChunkSize];
+	}
+
+	static FGridSnapshotChunkRef CopyChunk(const FGridTileStore& Tiles, int32 ChunkId);
+
+	uint32 Revision{0};
+	uint32 Version{0};
+	FIntVector2 Dimension{0,0};
+	int32 ChunksX{0};
+	TArray<FGridSnapshotChunkRef> Chunks{};
+	//Store revision of each chunk when it was copied
+	TArray<uint32> ChunkRevisions{};
+};
+
+using FGridSnapshotRef = TSharedRef<const FGridSnapshot, ESPMode::ThreadSafe>;
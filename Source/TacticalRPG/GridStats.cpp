@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridStats.h"
+
+DEFINE_STAT(STAT_GridSpawn);
+DEFINE_STAT(STAT_GridGroundTraceResults);
+DEFINE_STAT(STAT_GridFlushGeneratedChunk);
+DEFINE_STAT(STAT_GridRegenerateRegion);
+DEFINE_STAT(STAT_GridLoadBakedGrid);
+DEFINE_STAT(STAT_GridInstanceUpdates);
+DEFINE_STAT(STAT_GridSnapshot);
+
+DEFINE_STAT(STAT_GridFindPath);
+DEFINE_STAT(STAT_GridFindPathIncremental);
+DEFINE_STAT(STAT_GridFindPathHierarchical);
+DEFINE_STAT(STAT_GridMovementRange);
+DEFINE_STAT(STAT_GridShapeQuery);
+DEFINE_STAT(STAT_GridFieldsOfView);
+DEFINE_STAT(STAT_GridDistanceFieldUpdate);
+DEFINE_STAT(STAT_GridAIAction);
+DEFINE_STAT(STAT_GridBattleTurn);
+
+DEFINE_STAT(STAT_GridCursorPicking);
+DEFINE_STAT(STAT_GridHighlightFlush);
+
+DEFINE_STAT(STAT_GridNodesExpanded);
+DEFINE_STAT(STAT_GridNeighborsTested);
+DEFINE_STAT(STAT_GridTracesIssued);
+DEFINE_STAT(STAT_GridInstanceWrites);
+DEFINE_STAT(STAT_GridHighlightTileWrites);
+DEFINE_STAT(STAT_GridHighlightChunkUploads);
+
+UE_TRACE_CHANNEL_DEFINE(TacticalGridChannel);
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+DECLARE_STATS_GROUP(TEXT("TacticalGrid"), STATGROUP_TacticalGrid, STATCAT_Advanced);
+
+//Generation and tile edits
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spawn Grid"), STAT_GridSpawn, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ground Trace Results"), STAT_GridGroundTraceResults, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flush Generated Chunk"), STAT_GridFlushGeneratedChunk, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Regenerate Region"), STAT_GridRegenerateRegion, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load Baked Grid"), STAT_GridLoadBakedGrid, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Instance Updates"), STAT_GridInstanceUpdates, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tile Snapshot"), STAT_GridSnapshot, STATGROUP_TacticalGrid, TACTICALRPG_API);
+
+//Queries
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Path"), STAT_GridFindPath, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Path Incremental"), STAT_GridFindPathIncremental, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Path Hierarchical"), STAT_GridFindPathHierarchical, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement Range"), STAT_GridMovementRange, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Shape Query"), STAT_GridShapeQuery, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Fields Of View"), STAT_GridFieldsOfView, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Distance Field Update"), STAT_GridDistanceFieldUpdate, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("AI Action"), STAT_GridAIAction, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Battle Turn"), STAT_GridBattleTurn, STATGROUP_TacticalGrid, TACTICALRPG_API);
+
+//Input and presentation
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cursor Picking"), STAT_GridCursorPicking, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Highlight Flush"), STAT_GridHighlightFlush, STATGROUP_TacticalGrid, TACTICALRPG_API);
+
+//Per frame work counts
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes Expanded"), STAT_GridNodesExpanded, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Neighbors Tested"), STAT_GridNeighborsTested, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ground Traces Issued"), STAT_GridTracesIssued, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instance Writes"), STAT_GridInstanceWrites, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Highlight Tile Writes"), STAT_GridHighlightTileWrites, STATGROUP_TacticalGrid, TACTICALRPG_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Highlight Chunk Uploads"), STAT_GridHighlightChunkUploads, STATGROUP_TacticalGrid, TACTICALRPG_API);
+
+/** Insights channel of the grid scopes, enable it with -trace=cpu,TacticalGrid. Unlike stats it is compiled into Test and Shipping builds. */
+UE_TRACE_CHANNEL_EXTERN(TacticalGridChannel, TACTICALRPG_API);
+
+/** Cycle stat for "stat TacticalGrid" plus a CPU event of the same name on the TacticalGrid trace channel. */
+#define GRID_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, TacticalGridChannel)
@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridTacticalAI.h"
+
+#include "GridAsyncQuery.h"
+#include "GridStats.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	struct FGridAICandidate
+	{
+		int32 ActingIndex;
+		int32 RangeSlot;
+	};
+
+	//Small enough that a batch of candidates outweighs the cost of handing it to a worker
+	constexpr int32 MinCandidateBatchSize = 32;
+
+	int32 GetDistance(const FIntVector2& A, const FIntVector2& B)
+	{
+		return FMath::Abs(A.X - B.X) + FMath::Abs(A.Y - B.Y);
+	}
+}
+
+FGridAIAction FGridTacticalAI::FindBestAction(const FGridSnapshot& Snapshot, const TArrayView<const FGridAIUnit> Units, const int32 Team, const FGridAIScoring& Scoring)
+{
+	TArray<int32> ActingSlots;
+	for(int32 Slot = 0; Slot < Units.Num(); Slot++)
+	{
+		if(Units[Slot].Team == Team && Units[Slot].Health > 0)
+		{
+			ActingSlots.Add(Slot);
+		}
+	}
+	return FindBestAction(Snapshot, Units, ActingSlots, Scoring);
+}
+
+FGridAIAction FGridTacticalAI::FindBestActionForUnit(const FGridSnapshot& Snapshot, const TArrayView<const FGridAIUnit> Units, const int32 UnitSlot, const FGridAIScoring& Scoring)
+{
+	if(!Units.IsValidIndex(UnitSlot) || Units[UnitSlot].Health <= 0)
+	{
+		return {};
+	}
+	const int32 ActingSlots[1] {UnitSlot};
+	return FindBestAction(Snapshot, Units, ActingSlots, Scoring);
+}
+
+FGridAIAction FGridTacticalAI::FindBestAction(const FGridSnapshot& Snapshot, const TArrayView<const FGridAIUnit> Units, const TArrayView<const int32> ActingSlots, const FGridAIScoring& Scoring)
+{
+	GRID_SCOPE_CYCLE_COUNTER(STAT_GridAIAction);
+	TArray<FGridMovementRange> Ranges;
+	Ranges.SetNum(ActingSlots.Num());
+	ParallelFor(ActingSlots.Num(), [&](const int32 ActingIndex)
+	{
+		const FGridAIUnit& Unit = Units[ActingSlots[ActingIndex]];
+		const TGridMovementGraph<FGridSnapshot> Graph{Snapshot, Unit.MovementType, Unit.JumpPower};
+		if(Graph.IsSearchable(Unit.Location))
+		{
+			GridPathfinding::FindReachableTiles(Graph, GridAsyncQuery::GetWorkerSearchContext(), Graph.ToTileId(Unit.Location), Unit.MovementRange, Ranges[ActingIndex]);
+		}
+	});
+
+	//Flattened in unit then range order, the order ties are broken in
+	TArray<FGridAICandidate> Candidates;
+	for(int32 ActingIndex = 0; ActingIndex < Ranges.Num(); ActingIndex++)
+	{
+		for(int32 RangeSlot = 0; RangeSlot < Ranges[ActingIndex].Tiles.Num(); RangeSlot++)
+		{
+			Candidates.Add({ActingIndex, RangeSlot});
+		}
+	}
+
+	TArray<FGridAIAction> CandidateActions;
+	CandidateActions.SetNum(Candidates.Num());
+	ParallelFor(TEXT("GridAI.ScoreCandidates"), Candidates.Num(), MinCandidateBatchSize, [&](const int32 CandidateIndex)
+	{
+		const FGridAICandidate& Candidate = Candidates[CandidateIndex];
+		const FIntVector2& MoveTo = Ranges[Candidate.ActingIndex].Tiles[Candidate.RangeSlot];
+		CandidateActions[CandidateIndex] = ScoreCandidate(Snapshot, Units, ActingSlots[Candidate.ActingIndex], MoveTo, Scoring);
+	});
+
+	FGridAIAction BestAction;
+	for(const FGridAIAction& Action : CandidateActions)
+	{
+		if(Action.IsValid() && (!BestAction.IsValid() || Action.Score > BestAction.Score))
+		{
+			BestAction = Action;
+		}
+	}
+	return BestAction;
+}
+
+FGridAIAction FGridTacticalAI::ScoreCandidate(const FGridSnapshot& Snapshot, const TArrayView<const FGridAIUnit> Units, const int32 UnitSlot,
+	const FIntVector2& MoveTo, const FGridAIScoring& Scoring)
+{
+	const FGridAIUnit& Unit = Units[UnitSlot];
+	const int32 TileId = Snapshot.ToTileId(MoveTo);
+	const int32 Occupant = Snapshot.GetOccupant(TileId);
+	if(Occupant != INDEX_NONE && Occupant != Unit.Handle)
+	{
+		return {};
+	}
+
+	int32 NumThreats = 0;
+	int32 ClosestEnemyDistance = MAX_int32;
+	for(const FGridAIUnit& Other : Units)
+	{
+		if(Other.Team == Unit.Team || Other.Health <= 0)
+		{
+			continue;
+		}
+		const int32 Distance = GetDistance(MoveTo, Other.Location);
+		ClosestEnemyDistance = FMath::Min(ClosestEnemyDistance, Distance);
+		if(Distance <= Other.MovementRange + Other.AttackRange)
+		{
+			++NumThreats;
+		}
+	}
+
+	FGridAIAction Action;
+	Action.UnitHandle = Unit.Handle;
+	Action.MoveTo = MoveTo;
+	Action.Score = -Scoring.ExposurePenalty * NumThreats;
+	if(ClosestEnemyDistance != MAX_int32)
+	{
+		Action.Score -= Scoring.DistanceWeight * ClosestEnemyDistance;
+	}
+	const float WaitScore = Action.Score;
+
+	for(const FGridAIUnit& Target : Units)
+	{
+		if(Target.Team == Unit.Team || Target.Health <= 0 || GetDistance(MoveTo, Target.Location) > Unit.AttackRange)
+		{
+			continue;
+		}
+		const int32 Damage = FMath::Min(Unit.AttackPower, Target.Health);
+		const bool bKills = Damage >= Target.Health;
+		float Score = WaitScore + Scoring.DamageWeight * Damage;
+		if(bKills)
+		{
+			Score += Scoring.KillBonus;
+			//A dead target no longer threatens the destination
+			if(GetDistance(MoveTo, Target.Location) <= Target.MovementRange + Target.AttackRange)
+			{
+				Score += Scoring.ExposurePenalty;
+			}
+		}
+		if(Snapshot.HasTile(Target.Location))
+		{
+			Score += Scoring.HeightAdvantageWeight * (Snapshot.GetHeight(TileId) - Snapshot.GetHeight(Snapshot.ToTileId(Target.Location)));
+		}
+		if(Score > Action.Score)
+		{
+			Action.TargetHandle = Target.Handle;
+			Action.Score = Score;
+		}
+	}
+	return Action;
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridPathfinding.h"
+#include "GridSnapshot.h"
+
+/** Combat relevant state of a unit, as seen by the AI. Handle matches the occupant handle of its tile. */
+struct TACTICALRPG_API FGridAIUnit
+{
+	int32 Handle{INDEX_NONE};
+	int32 Team{0};
+	FIntVector2 Location{0,0};
+	int32 MovementRange{0};
+	uint8 MovementType{0};
+	int32 JumpPower{0};
+	int32 AttackRange{1};
+	int32 AttackPower{0};
+	int32 Health{1};
+};
+
+/** Move to MoveTo, then attack TargetHandle, or just wait there when it is INDEX_NONE. */
+struct TACTICALRPG_API FGridAIAction
+{
+	int32 UnitHandle{INDEX_NONE};
+	FIntVector2 MoveTo{0,0};
+	int32 TargetHandle{INDEX_NONE};
+	float Score{-MAX_flt};
+
+	bool IsValid() const {return UnitHandle != INDEX_NONE;}
+};
+
+struct TACTICALRPG_API FGridAIScoring
+{
+	//Per point of damage dealt
+	float DamageWeight{1.f};
+	//Added when the attack kills its target
+	float KillBonus{10.f};
+	//Per enemy that could attack the destination on its next turn
+	float ExposurePenalty{2.f};
+	//Per tile of distance left to the closest enemy, makes units without a target close in
+	float DistanceWeight{0.5f};
+	//Per height unit above the target
+	float HeightAdvantageWeight{0.25f};
+};
+
+/**
+ * Picks the best move and attack for a team. Every (unit, reachable tile) candidate is scored on the task graph
+ * workers against an immutable grid snapshot, each worker searching with its own scratch context. Candidates keep a
+ * fixed order and ties go to the first one, so the result does not depend on how the work was scheduled.
+ */
+class TACTICALRPG_API FGridTacticalAI
+{
+public:
+	/** Best action among every unit of Team, an invalid action if none of them can act. */
+	static FGridAIAction FindBestAction(const FGridSnapshot& Snapshot, TArrayView<const FGridAIUnit> Units, int32 Team, const FGridAIScoring& Scoring = {});
+
+	/** Best action of the unit at UnitSlot in Units. */
+	static FGridAIAction FindBestActionForUnit(const FGridSnapshot& Snapshot, TArrayView<const FGridAIUnit> Units, int32 UnitSlot, const FGridAIScoring& Scoring = {});
+
+private:
+	static FGridAIAction FindBestAction(const FGridSnapshot& Snapshot, TArrayView<const FGridAIUnit> Units, TArrayView<const int32> ActingSlots, const FGridAIScoring& Scoring);
+	static FGridAIAction ScoreCandidate(const FGridSnapshot& Snapshot, TArrayView<const FGridAIUnit> Units, int32 UnitSlot, const FIntVector2& MoveTo, const FGridAIScoring& Scoring);
+};
@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridTileStore.h"
+
+#include "GridUtilities.h"
+
+void FGridTileStore::Init(const FIntVector2& InDimension)
+{
+	Dimension = {FMath::Max(InDimension.X, 0), FMath::Max(InDimension.Y, 0)};
+	NumTiles = 0;
+	const int32 NumCells = GetNumCells();
+	TileMask.Init(false, NumCells);
+	MovementCost.Init(1, NumCells);
+	Height.Init(1, NumCells);
+	AllowedMovementTypes.Init(static_cast<uint8>(EGridMovementType::None), NumCells);
+	TileState.Init(0, NumCells);
+	InstanceIndex.Init(INDEX_NONE, NumCells);
+	Occupant.Init(INDEX_NONE, NumCells);
+	Elevation.Init(0.f, NumCells);
+	TypeNeighborMasks.Init(0, NumCells);
+	JumpNeighborMasks.Init(0, NumCells);
+	SteepNeighborMasks.Init(0, NumCells);
+	ChunkInstanceTiles.Empty(GetNumChunks());
+	ChunkInstanceTiles.SetNum(GetNumChunks());
+	ChunkRevisions.Init(++Revision, GetNumChunks());
+	//Nothing logged before this point refers to the new layout
+	++Version;
+	ChangeLogBaseVersion = Version;
+	ChangeLog.Reset();
+}
+
+void FGridTileStore::Reset()
+{
+	Init({0,0});
+}
+
+void FGridTileStore::AddTile(const int32 TileId, const int32 InInstanceIndex, const int32 InMovementCost, const uint8 InAllowedMovementTypes, const int32 InHeight)
+{
+	if(!TileMask[TileId])
+	{
+		++NumTiles;
+	}
+	TileMask[TileId] = true;
+	SetInstanceIndex(TileId, InInstanceIndex);
+	MovementCost[TileId] = ClampMovementCost(InMovementCost);
+	AllowedMovementTypes[TileId] = InAllowedMovementTypes;
+	Height[TileId] = InHeight;
+	TileState[TileId] = 0;
+	Occupant[TileId] = INDEX_NONE;
+	RefreshNeighborMasksAround(TileId);
+	MarkChanged(TileId);
+}
+
+void FGridTileStore::RemoveTile(const int32 TileId)
+{
+	if(!TileMask[TileId])
+	{
+		return;
+	}
+	--NumTiles;
+	TileMask[TileId] = false;
+	SetInstanceIndex(TileId, INDEX_NONE);
+	MovementCost[TileId] = 1;
+	AllowedMovementTypes[TileId] = static_cast<uint8>(EGridMovementType::None);
+	Height[TileId] = 1;
+	TileState[TileId] = 0;
+	Occupant[TileId] = INDEX_NONE;
+	Elevation[TileId] = 0.f;
+	RefreshNeighborMasksAround(TileId);
+	MarkChanged(TileId);
+}
+
+void FGridTileStore::SetHeight(const int32 TileId, const int32 InHeight)
+{
+	Height[TileId] = InHeight;
+	RefreshNeighborMasksAround(TileId);
+	MarkChanged(TileId);
+}
+
+void FGridTileStore::SetAllowedMovementTypes(const int32 TileId, const uint8 InAllowedMovementTypes)
+{
+	AllowedMovementTypes[TileId] = InAllowedMovementTypes;
+	RefreshNeighborMasksAround(TileId);
+	MarkChanged(TileId);
+}
+
+void FGridTileStore::SetInstanceIndex(const int32 TileId, const int32 InInstanceIndex)
+{
+	TArray<int32>& InstanceTiles = ChunkInstanceTiles[GetChunkId(TileId)];
+	const int32 PreviousInstanceIndex = InstanceIndex[TileId];
+	if(InstanceTiles.IsValidIndex(PreviousInstanceIndex) && InstanceTiles[PreviousInstanceIndex] == TileId)
+	{
+		InstanceTiles[PreviousInstanceIndex] = INDEX_NONE;
+	}
+	InstanceIndex[TileId] = InInstanceIndex;
+	if(InInstanceIndex == INDEX_NONE)
+	{
+		return;
+	}
+	while(InstanceTiles.Num() <= InInstanceIndex)
+	{
+		InstanceTiles.Add(INDEX_NONE);
+	}
+	InstanceTiles[InInstanceIndex] = TileId;
+}
+
+void FGridTileStore::RefreshNeighborMasksAround(const int32 TileId)
+{
+	const int32 X = TileId % Dimension.X;
+	RefreshNeighborMasks(TileId);
+	if(X > 0)
+	{
+		RefreshNeighborMasks(TileId - 1);
+	}
+	if(X < Dimension.X - 1)
+	{
+		RefreshNeighborMasks(TileId + 1);
+	}
+	if(TileId >= Dimension.X)
+	{
+		RefreshNeighborMasks(TileId - Dimension.X);
+	}
+	if(TileId + Dimension.X < GetNumCells())
+	{
+		RefreshNeighborMasks(TileId + Dimension.X);
+	}
+}
+
+void FGridTileStore::RefreshNeighborMasks(const int32 TileId)
+{
+	const int32 X = TileId % Dimension.X;
+	const bool bHasNeighbor[4] {X > 0, X < Dimension.X - 1, TileId >= Dimension.X, TileId + Dimension.X < GetNumCells()};
+	const int32 NeighborOffsets[4] {-1, 1, -Dimension.X, Dimension.X};
+	uint32 TypeMasks = 0;
+	uint64 JumpMasks = 0;
+	uint8 SteepMask = 0;
+	for(int32 Direction = 0; Direction < 4; Direction++)
+	{
+		const int32 NeighborId = TileId + NeighborOffsets[Direction];
+		if(!bHasNeighbor[Direction] || !TileMask[NeighborId])
+		{
+			continue;
+		}
+		for(uint32 MoveTypes = 1; MoveTypes < 8; MoveTypes++)
+		{
+			if(IsTileWalkable(NeighborId, MoveTypes))
+			{
+				TypeMasks |= 1u << (MoveTypes * 4 + Direction);
+			}
+		}
+		const int32 HeightDelta = FMath::Abs(Height[NeighborId] - Height[TileId]);
+		if(HeightDelta >= NumJumpBuckets)
+		{
+			SteepMask |= 1 << Direction;
+			continue;
+		}
+		for(int32 Bucket = HeightDelta; Bucket < NumJumpBuckets; Bucket++)
+		{
+			JumpMasks |= 1ull << (Bucket * 4 + Direction);
+		}
+	}
+	TypeNeighborMasks[TileId] = TypeMasks;
+	JumpNeighborMasks[TileId] = JumpMasks;
+	SteepNeighborMasks[TileId] = SteepMask;
+	MarkChunkDirty(TileId);
+}
+
+uint8 FGridTileStore::GetSteepNeighborMask(const int32 TileId, const int32 JumpPower) const
+{
+	const int32 NeighborOffsets[4] {-1, 1, -Dimension.X, Dimension.X};
+	uint8 Mask = 0;
+	for(int32 Direction = 0; Direction < 4; Direction++)
+	{
+		if((SteepNeighborMasks[TileId] & (1 << Direction)) != 0 && FMath::Abs(Height[TileId + NeighborOffsets[Direction]] - Height[TileId]) <= JumpPower)
+		{
+			Mask |= 1 << Direction;
+		}
+	}
+	return Mask;
+}
+
+void FGridTileStore::MarkChanged(const int32 TileId)
+{
+	if(ChangeLog.Num() >= MaxChangeLogSize)
+	{
+		const int32 NumDropped = ChangeLog.Num() / 2;
+		ChangeLog.RemoveAt(0, NumDropped, false);
+		ChangeLogBaseVersion += NumDropped;
+	}
+	ChangeLog.Add(TileId);
+	++Version;
+}
@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Dense structure-of-arrays storage for every tile of a grid, indexed by tile id (Y * Width + X).
+ * Cells without a tile (holes left by blocking volumes or missing ground) are cleared in the occupancy mask, their
+ * other fields keep default values. Occupants are stored as handles so the store carries no UObject references.
+ */
+class TACTICALRPG_API FGridTileStore
+{
+public:
+	//Tiles are grouped in square chunks that are rendered, generated and invalidated independently
+	static constexpr int32 ChunkSize = 32;
+	//Jump powers with a precomputed neighbor mask, higher ones share the last bucket
+	static constexpr int32 NumJumpBuckets = 16;
+
+	/** Clears the store and sizes it for an empty grid of the given dimension. */
+	void Init(const FIntVector2& InDimension);
+	void Reset();
+
+	const FIntVector2& GetDimension() const {return Dimension;}
+	int32 GetNumCells() const {return Dimension.X * Dimension.Y;}
+	int32 GetNumTiles() const {return NumTiles;}
+
+	bool IsInBounds(const FIntVector2& Index) const {return Index.X >= 0 && Index.Y >= 0 && Index.X < Dimension.X && Index.Y < Dimension.Y;}
+	int32 ToTileId(const FIntVector2& Index) const {return Index.Y * Dimension.X + Index.X;}
+	FIntVector2 ToGridIndex(const int32 TileId) const {return {TileId % Dimension.X, TileId / Dimension.X};}
+
+	/** Number of chunks along each axis, chunk ids are row-major like tile ids. */
+	FIntVector2 GetChunkGridDimension() const {return {FMath::DivideAndRoundUp(Dimension.X, ChunkSize), FMath::DivideAndRoundUp(Dimension.Y, ChunkSize)};}
+	int32 GetNumChunks() const {const FIntVector2 ChunkGrid = GetChunkGridDimension(); return ChunkGrid.X * ChunkGrid.Y;}
+	int32 GetChunkId(const int32 TileId) const
+	{
+		const FIntVector2 Index = ToGridIndex(TileId);
+		return (Index.Y / ChunkSize) * GetChunkGridDimension().X + Index.X / ChunkSize;
+	}
+
+	/** Calls Func(TileId) for every cell of the chunk, including holes. */
+	template<typename FuncType>
+	void ForEachCellInChunk(const int32 ChunkId, FuncType&& Func) const
+	{
+		const int32 ChunksX = GetChunkGridDimension().X;
+		const int32 MinX = (ChunkId % ChunksX) * ChunkSize;
+		const int32 MinY = (ChunkId / ChunksX) * ChunkSize;
+		const int32 MaxX = FMath::Min(MinX + ChunkSize, Dimension.X);
+		const int32 MaxY = FMath::Min(MinY + ChunkSize, Dimension.Y);
+		for(int32 Y = MinY; Y < MaxY; Y++)
+		{
+			for(int32 X = MinX; X < MaxX; X++)
+			{
+				Func(Y * Dimension.X + X);
+			}
+		}
+	}
+
+	bool HasTile(const int32 TileId) const {return TileMask[TileId];}
+	bool HasTile(const FIntVector2& Index) const {return IsInBounds(Index) && TileMask[ToTileId(Index)];}
+	const TBitArray<>& GetTileMask() const {return TileMask;}
+
+	void AddTile(int32 TileId, int32 InInstanceIndex, int32 InMovementCost, uint8 InAllowedMovementTypes, int32 InHeight = 1);
+	void RemoveTile(int32 TileId);
+
+	/** Tile rendered by the given instance of a chunk's mesh, INDEX_NONE if there is none. */
+	int32 FindTileByInstance(const int32 ChunkId, const int32 InInstanceIndex) const
+	{
+		const TArray<int32>& InstanceTiles = ChunkInstanceTiles[ChunkId];
+		return InstanceTiles.IsValidIndex(InInstanceIndex) ? InstanceTiles[InInstanceIndex] : INDEX_NONE;
+	}
+
+	int32 GetMovementCost(const int32 TileId) const {return MovementCost[TileId];}
+	void SetMovementCost(const int32 TileId, const int32 InMovementCost) {MovementCost[TileId] = ClampMovementCost(InMovementCost); MarkChunkDirty(TileId); MarkChanged(TileId);}
+	//The search heuristic counts every step as at least 1, a cheaper tile would make it overestimate
+	static int32 ClampMovementCost(const int32 InMovementCost) {return FMath::Max(InMovementCost, 1);}
+
+	int32 GetHeight(const int32 TileId) const {return Height[TileId];}
+	void SetHeight(int32 TileId, int32 InHeight);
+
+	uint8 GetAllowedMovementTypes(const int32 TileId) const {return AllowedMovementTypes[TileId];}
+	void SetAllowedMovementTypes(int32 TileId, uint8 InAllowedMovementTypes);
+	bool IsTileWalkable(const int32 TileId, const uint8 MoveTypeToCheck) const {return (AllowedMovementTypes[TileId] & MoveTypeToCheck) != 0;}
+
+	/**
+	 * Directions a unit can step to from the tile: bit 0 (X-1,Y), bit 1 (X+1,Y), bit 2 (X,Y-1), bit 3 (X,Y+1).
+	 * A neighbor is set when it exists, allows one of MoveTypes and its height differs by at most JumpPower.
+	 */
+	uint8 GetNeighborMask(const int32 TileId, const uint8 MoveTypes, const int32 JumpPower) const
+	{
+		if(JumpPower < 0)
+		{
+			return 0;
+		}
+		const uint8 SteepMask = JumpPower >= NumJumpBuckets - 1 && SteepNeighborMasks[TileId] != 0 ? GetSteepNeighborMask(TileId, JumpPower) : 0;
+		return CombineNeighborMasks(TypeNeighborMasks[TileId], JumpNeighborMasks[TileId], SteepMask, MoveTypes, JumpPower);
+	}
+
+	/** Picks the movement type and jump bucket masks out of a cell's packed neighbor masks. */
+	static uint8 CombineNeighborMasks(const uint32 TypeMasks, const uint64 JumpMasks, const uint8 SteepMask, const uint8 MoveTypes, const int32 JumpPower)
+	{
+		const uint8 TypeMask = (TypeMasks >> ((MoveTypes & 7) * 4)) & 0xF;
+		const uint8 JumpMask = (JumpMasks >> (FMath::Min(JumpPower, NumJumpBuckets - 1) * 4)) & 0xF;
+		return TypeMask & (JumpMask | SteepMask);
+	}
+
+	uint8 GetTileState(const int32 TileId) const {return TileState[TileId];}
+	void AddState(const int32 TileId, const uint8 InState) {TileState[TileId] |= InState; MarkChunkDirty(TileId);}
+	void RemoveState(const int32 TileId, const uint8 InState) {TileState[TileId] &= ~InState; MarkChunkDirty(TileId);}
+
+	//Index of the tile's instance inside its chunk's mesh component
+	int32 GetInstanceIndex(const int32 TileId) const {return InstanceIndex[TileId];}
+	void SetInstanceIndex(int32 TileId, int32 InInstanceIndex);
+
+	//Local Z of the tile surface, used to map world positions back onto the grid
+	float GetElevation(const int32 TileId) const {return Elevation[TileId];}
+	void SetElevation(const int32 TileId, const float InElevation) {Elevation[TileId] = InElevation;}
+
+	int32 GetOccupant(const int32 TileId) const {return Occupant[TileId];}
+	void SetOccupant(const int32 TileId, const int32 OccupantHandle)
+	{
+		if(Occupant[TileId] == OccupantHandle)
+		{
+			return;
+		}
+		Occupant[TileId] = OccupantHandle;
+		MarkChunkDirty(TileId);
+	}
+	bool IsTileOccupied(const int32 TileId) const {return Occupant[TileId] != INDEX_NONE;}
+
+	/** Bumped by every change to any tile data, including states and occupants. */
+	uint32 GetRevision() const {return Revision;}
+	//Revision of the last change inside the chunk, readers holding a copy of the chunk compare it to know if it is stale
+	uint32 GetChunkRevision(const int32 ChunkId) const {return ChunkRevisions[ChunkId];}
+
+	/** Bumped by every change that affects movement: tiles added or removed, cost, height or allowed movement types. */
+	uint32 GetVersion() const {return Version;}
+
+	/**
+	 * Calls Func(TileId) for every movement change made after SinceVersion, oldest first. Returns false without calling
+	 * Func if the log no longer reaches back that far or the grid was re-initialized since, callers then rebuild.
+	 */
+	template<typename FuncType>
+	bool ForEachChangeSince(const uint32 SinceVersion, FuncType&& Func) const
+	{
+		if(SinceVersion < ChangeLogBaseVersion || SinceVersion > Version)
+		{
+			return false;
+		}
+		for(int32 i = SinceVersion - ChangeLogBaseVersion; i < ChangeLog.Num(); i++)
+		{
+			Func(ChangeLog[i]);
+		}
+		return true;
+	}
+
+private:
+	friend class FGridSnapshot;
+
+	void MarkChanged(int32 TileId);
+	void MarkChunkDirty(const int32 TileId) {ChunkRevisions[GetChunkId(TileId)] = ++Revision;}
+
+	/** Recomputes the neighbor masks of a cell and of the four cells next to it. */
+	void RefreshNeighborMasksAround(int32 TileId);
+	void RefreshNeighborMasks(int32 TileId);
+	uint8 GetSteepNeighborMask(int32 TileId, int32 JumpPower) const;
+
+	//Oldest changes are dropped past this size, listeners that fell further behind rebuild from scratch
+	static constexpr int32 MaxChangeLogSize = 4096;
+
+	FIntVector2 Dimension{0,0};
+	int32 NumTiles{0};
+
+	TBitArray<> TileMask{};
+	TArray<int32> MovementCost{};
+	TArray<int32> Height{};
+	TArray<uint8> AllowedMovementTypes{};
+	TArray<uint8> TileState{};
+	TArray<int32> InstanceIndex{};
+	TArray<int32> Occupant{};
+	TArray<float> Elevation{};
+
+	//Per cell, 4 direction bits for each of the 8 movement type combinations, indexed by the combination
+	TArray<uint32> TypeNeighborMasks{};
+	//Per cell, 4 direction bits for each jump bucket: bucket B holds the neighbors at most B height units away
+	TArray<uint64> JumpNeighborMasks{};
+	//Per cell, neighbors further than the last jump bucket, checked exactly for very high jump powers
+	TArray<uint8> SteepNeighborMasks{};
+
+	//Per chunk, instance index -> tile id. Reverse of InstanceIndex so picking never searches for a tile
+	TArray<TArray<int32>> ChunkInstanceTiles{};
+
+	uint32 Revision{0};
+	TArray<uint32> ChunkRevisions{};
+
+	uint32 Version{0};
+	//Version before the first entry of ChangeLog, Version == ChangeLogBaseVersion + ChangeLog.Num()
+	uint32 ChangeLogBaseVersion{0};
+	TArray<int32> ChangeLog{};
+};
+
+/**
+ * Non-owning restriction of a grid query to a subset of tiles: an optional tile id mask and/or a maximum Manhattan
+ * distance from a center tile. Default constructed filters accept every tile. Cheap to copy, never allocates; the
+ * mask must outlive the query.
+ */
+class TACTICALRPG_API FGridTileFilter
+{
+public:
+	FGridTileFilter() = default;
+	explicit FGridTileFilter(const TBitArray<>& InTileMask) : TileMask(&InTileMask) {}
+
+	static FGridTileFilter WithinDistance(const FIntVector2& InCenter, const int32 InMaxDistance)
+	{
+		FGridTileFilter Filter;
+		Filter.Center = InCenter;
+		Filter.MaxDistance = InMaxDistance;
+		return Filter;
+	}
+
+	bool IsUnrestricted() const {return TileMask == nullptr && MaxDistance < 0;}
+
+	template<typename TileSourceType>
+	bool Accepts(const TileSourceType& Tiles, const int32 TileId) const
+	{
+		if(TileMask != nullptr && !(*TileMask)[TileId])
+		{
+			return false;
+		}
+		if(MaxDistance >= 0)
+		{
+			const FIntVector2 Index = Tiles.ToGridIndex(TileId);
+			return FMath::Abs(Index.X - Center.X) + FMath::Abs(Index.Y - Center.Y) <= MaxDistance;
+		}
+		return true;
+	}
+
+private:
+	const TBitArray<>* TileMask{nullptr};
+	FIntVector2 Center{0,0};
+	int32 MaxDistance{-1};
+};
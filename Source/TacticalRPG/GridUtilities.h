@@ -20,6 +20,28 @@ enum class EGridMovementType : uint8
 	Any = Ground + Aquatic + Aerial UMETA(Hidden, DisplayName="Free Movement", DisplayTooltip="Unit may only move on air terrain. If set to a GridModifierVolume, tiles generated in that area will not block the movement of any unit.")
 };
 ENUM_CLASS_FLAGS(EGridMovementType);
+
+/** Area shapes abilities target, see FGridShapeStencil for the exact footprint of each. */
+UENUM(BlueprintType)
+enum class EGridShapeType : uint8
+{
+	Diamond UMETA(DisplayTooltip="Tiles within Radius steps (Manhattan distance), center included."),
+	Square UMETA(DisplayTooltip="Tiles within Radius on both axes, center included."),
+	Circle UMETA(DisplayTooltip="Tiles within Radius (Euclidean distance, rounded outward), center included."),
+	Cross UMETA(DisplayTooltip="Tiles on the center row and column within Radius, center included."),
+	Ring UMETA(DisplayTooltip="Tiles between InnerRadius and Radius steps (Manhattan distance)."),
+	Line UMETA(DisplayTooltip="Radius tiles straight ahead in Direction, center excluded."),
+	Cone UMETA(DisplayTooltip="Widening cone Radius tiles deep in Direction, one tile wide at its tip, center excluded.")
+};
+
+UENUM(BlueprintType)
+enum class EGridDirection : uint8
+{
+	PositiveX,
+	NegativeX,
+	PositiveY,
+	NegativeY
+};
 /**
  * 
  */
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridVisibility.h"
+
+#include "Async/ParallelFor.h"
+
+FGridFieldOfViewRef FGridVisibilityCache::GetFieldOfView(const FGridTileStore& Tiles, const FGridSightQuery& Query)
+{
+	const FKey Key{Query, Tiles.GetVersion()};
+	if(const TSharedPtr<const FGridFieldOfView, ESPMode::ThreadSafe>* CachedFieldOfView = Entries.FindAndTouch(Key))
+	{
+		return CachedFieldOfView->ToSharedRef();
+	}
+	const TSharedRef<FGridFieldOfView, ESPMode::ThreadSafe> FieldOfView = MakeShared<FGridFieldOfView, ESPMode::ThreadSafe>();
+	GridVisibility::ComputeFieldOfView(Tiles, Query, *FieldOfView);
+	Entries.Add(Key, FieldOfView);
+	return FieldOfView;
+}
+
+void FGridVisibilityCache::GetFieldsOfView(const FGridSnapshot& Snapshot, const TArrayView<const FGridSightQuery> Queries, TArray<FGridFieldOfViewRef>& OutFieldsOfView)
+{
+	TArray<TSharedPtr<const FGridFieldOfView, ESPMode::ThreadSafe>> Results;
+	Results.SetNum(Queries.Num());
+	TArray<int32> MissSlots;
+	for(int32 Slot = 0; Slot < Queries.Num(); Slot++)
+	{
+		if(const TSharedPtr<const FGridFieldOfView, ESPMode::ThreadSafe>* CachedFieldOfView = Entries.FindAndTouch({Queries[Slot], Snapshot.GetVersion()}))
+		{
+			Results[Slot] = *CachedFieldOfView;
+		}
+		else
+		{
+			MissSlots.Add(Slot);
+		}
+	}
+
+	ParallelFor(MissSlots.Num(), [&](const int32 MissIndex)
+	{
+		const int32 Slot = MissSlots[MissIndex];
+		const TSharedRef<FGridFieldOfView, ESPMode::ThreadSafe> FieldOfView = MakeShared<FGridFieldOfView, ESPMode::ThreadSafe>();
+		GridVisibility::ComputeFieldOfView(Snapshot, Queries[Slot], *FieldOfView);
+		Results[Slot] = FieldOfView;
+	});
+
+	//Workers never touch the cache, misses are added back on the calling thread
+	for(const int32 Slot : MissSlots)
+	{
+		Entries.Add({Queries[Slot], Snapshot.GetVersion()}, Results[Slot]);
+	}
+	OutFieldsOfView.Reset(Queries.Num());
+	for(const TSharedPtr<const FGridFieldOfView, ESPMode::ThreadSafe>& Result : Results)
+	{
+		OutFieldsOfView.Add(Result.ToSharedRef());
+	}
+}
@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+#include "GridSnapshot.h"
+#include "GridTileStore.h"
+
+/** What a unit standing on Origin can see: tiles within Radius (Euclidean) whose surface is not hidden by higher tiles. */
+struct TACTICALRPG_API FGridSightQuery
+{
+	FIntVector2 Origin{0,0};
+	int32 Radius{0};
+	//Eye height above the origin tile surface
+	int32 EyeHeight{1};
+	//Height above a tile surface that has to be visible, 0 targets the surface itself, a unit height targets a unit standing on it
+	int32 TargetHeight{0};
+
+	bool operator==(const FGridSightQuery& Other) const
+	{
+		return Origin == Other.Origin && Radius == Other.Radius && EyeHeight == Other.EyeHeight && TargetHeight == Other.TargetHeight;
+	}
+};
+
+/** Visibility bitset of one sight query, covering only the square of side 2 * Radius + 1 around the origin. */
+struct TACTICALRPG_API FGridFieldOfView
+{
+	FIntVector2 Min{0,0};
+	int32 Size{0};
+	TBitArray<> Visible{};
+
+	bool IsVisible(const FIntVector2& Index) const
+	{
+		const int32 X = Index.X - Min.X;
+		const int32 Y = Index.Y - Min.Y;
+		return X >= 0 && Y >= 0 && X < Size && Y < Size && Visible[Y * Size + X];
+	}
+
+	template<typename FuncType>
+	void ForEachVisibleTile(FuncType&& Func) const
+	{
+		for(TConstSetBitIterator<> It(Visible); It; ++It)
+		{
+			Func(FIntVector2{Min.X + It.GetIndex() % Size, Min.Y + It.GetIndex() / Size});
+		}
+	}
+};
+using FGridFieldOfViewRef = TSharedRef<const FGridFieldOfView, ESPMode::ThreadSafe>;
+
+/**
+ * Line of sight over the tile height field, no physics involved. A sight line runs from the eye above the origin to
+ * the target point above the target tile and is blocked by any tile on its Bresenham line rising strictly above it.
+ * Holes never block. Templated on the tile source like the pathfinding, so it runs on the store or on a snapshot.
+ */
+namespace GridVisibility
+{
+	template<typename TileSourceType>
+	bool HasLineOfSight(const TileSourceType& Tiles, const FIntVector2& From, const FIntVector2& To, const int32 EyeHeight, const int32 TargetHeight)
+	{
+		if(!Tiles.HasTile(From) || !Tiles.HasTile(To))
+		{
+			return false;
+		}
+		const int32 DeltaX = FMath::Abs(To.X - From.X);
+		const int32 DeltaY = FMath::Abs(To.Y - From.Y);
+		const int32 StepX = To.X > From.X ? 1 : -1;
+		const int32 StepY = To.Y > From.Y ? 1 : -1;
+		const int32 NumSteps = FMath::Max(DeltaX, DeltaY);
+		const int64 Eye = Tiles.GetHeight(Tiles.ToTileId(From)) + EyeHeight;
+		const int64 Rise = Tiles.GetHeight(Tiles.ToTileId(To)) + TargetHeight - Eye;
+		int32 X = From.X;
+		int32 Y = From.Y;
+		int32 Error = DeltaX - DeltaY;
+		//Each step advances the major axis by one, so at step I the line is at Eye + Rise * I / NumSteps
+		for(int32 Step = 1; Step < NumSteps; Step++)
+		{
+			const int32 DoubleError = 2 * Error;
+			if(DoubleError > -DeltaY)
+			{
+				Error -= DeltaY;
+				X += StepX;
+			}
+			if(DoubleError < DeltaX)
+			{
+				Error += DeltaX;
+				Y += StepY;
+			}
+			const int32 TileId = Y * Tiles.GetDimension().X + X;
+			if(Tiles.HasTile(TileId) && static_cast<int64>(Tiles.GetHeight(TileId)) * NumSteps > Eye * NumSteps + Rise * Step)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename TileSourceType>
+	void ComputeFieldOfView(const TileSourceType& Tiles, const FGridSightQuery& Query, FGridFieldOfView& OutFieldOfView)
+	{
+		const int32 Radius = FMath::Max(Query.Radius, 0);
+		OutFieldOfView.Min = {Query.Origin.X - Radius, Query.Origin.Y - Radius};
+		OutFieldOfView.Size = 2 * Radius + 1;
+		OutFieldOfView.Visible.Init(false, OutFieldOfView.Size * OutFieldOfView.Size);
+		if(!Tiles.HasTile(Query.Origin))
+		{
+			return;
+		}
+		for(int32 OffsetY = -Radius; OffsetY <= Radius; OffsetY++)
+		{
+			for(int32 OffsetX = -Radius; OffsetX <= Radius; OffsetX++)
+			{
+				const FIntVector2 Target{Query.Origin.X + OffsetX, Query.Origin.Y + OffsetY};
+				if(OffsetX * OffsetX + OffsetY * OffsetY <= Radius * Radius && HasLineOfSight(Tiles, Query.Origin, Target, Query.EyeHeight, Query.TargetHeight))
+				{
+					OutFieldOfView.Visible[(OffsetY + Radius) * OutFieldOfView.Size + OffsetX + Radius] = true;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Fields of view computed so far, keyed by the sight query and the tile store version: heights and tiles only change
+ * with the version, so entries of an older one are never hit again and age out of the LRU. Game thread only; the
+ * batched lookup fans the misses out over the task graph workers.
+ */
+class TACTICALRPG_API FGridVisibilityCache
+{
+public:
+	explicit FGridVisibilityCache(const int32 MaxEntries = 256) : Entries(MaxEntries) {}
+
+	FGridFieldOfViewRef GetFieldOfView(const FGridTileStore& Tiles, const FGridSightQuery& Query);
+	/** Fields of view of every query, in query order. Misses are computed in parallel against the snapshot. */
+	void GetFieldsOfView(const FGridSnapshot& Snapshot, TArrayView<const FGridSightQuery> Queries, TArray<FGridFieldOfViewRef>& OutFieldsOfView);
+
+	void Empty() {Entries.Empty(Entries.Max());}
+
+private:
+	struct FKey
+	{
+		FGridSightQuery Query;
+		uint32 GridVersion;
+
+		bool operator==(const FKey& Other) const {return Query == Other.Query && GridVersion == Other.GridVersion;}
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			uint32 Hash = HashCombine(GetTypeHash(Key.Query.Origin), GetTypeHash(Key.Query.Radius));
+			Hash = HashCombine(Hash, GetTypeHash(Key.Query.EyeHeight));
+			Hash = HashCombine(Hash, GetTypeHash(Key.Query.TargetHeight));
+			return HashCombine(Hash, GetTypeHash(Key.GridVersion));
+		}
+	};
+
+	TLruCache<FKey, TSharedPtr<const FGridFieldOfView, ESPMode::ThreadSafe>> Entries;
+};
@@ -22,6 +22,20 @@ void ATacticalBattleCharacter::BeginPlay()
 	
 }
 
+FGridAIUnit ATacticalBattleCharacter::MakeBattleUnit(const FIntVector2& Location) const
+{
+	FGridAIUnit Unit;
+	Unit.Team = Team;
+	Unit.Location = Location;
+	Unit.MovementRange = MovementRange;
+	Unit.MovementType = MovementType;
+	Unit.JumpPower = JumpPower;
+	Unit.AttackRange = AttackRange;
+	Unit.AttackPower = AttackPower;
+	Unit.Health = MaxHealth;
+	return Unit;
+}
+
 // Called every frame
 void ATacticalBattleCharacter::Tick(float DeltaTime)
 {
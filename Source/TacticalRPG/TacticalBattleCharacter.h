@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "GridTacticalAI.h"
+#include "GridUtilities.h"
 #include "TacticalBattleCharacter.generated.h"
 
 UCLASS()
@@ -23,6 +25,25 @@ protected:
 
 	FIntVector2 CurrentPosition {-1,-1};
 
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Battle")
+	int32 Team{0};
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Battle")
+	int32 MovementRange{5};
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Battle", meta=(BitMask, BitMaskEnum = "/Script/TacticalRPG.EGridMovementType"))
+	uint8 MovementType{static_cast<uint8>(EGridMovementType::Ground)};
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Battle")
+	int32 JumpPower{2};
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Battle")
+	int32 AttackRange{1};
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Battle")
+	int32 AttackPower{3};
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Battle")
+	int32 MaxHealth{10};
+
+	/** Simulation unit with this character's stats, standing on Location at full health. */
+	FGridAIUnit MakeBattleUnit(const FIntVector2& Location) const;
+
 public:
 	
 	// Called every frame